@@ -0,0 +1,52 @@
+#include "NesCPUAOT.hpp"
+
+static const CPUAOTProgram* g_programs[CPU_AOT_MAX_PROGRAMS] = { 0 };
+static int g_programCount = 0;
+
+// FNV-1a
+uint32_t CpuAOTHashPRGRom(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool CpuAOTRegister(const CPUAOTProgram* program) {
+    if (g_programCount >= CPU_AOT_MAX_PROGRAMS) {
+        return false;
+    }
+    g_programs[g_programCount++] = program;
+    return true;
+}
+
+const CPUAOTProgram* CpuAOTFindProgram(const INesFile* file) {
+    if (g_programCount == 0) {
+        return NULL;
+    }
+    uint32_t hash = CpuAOTHashPRGRom(file->PRGRom, file->PRGRomSize);
+    for (int i = 0; i < g_programCount; ++i) {
+        if (g_programs[i]->PRGRomHash == hash && g_programs[i]->PRGRomSize == file->PRGRomSize) {
+            return g_programs[i];
+        }
+    }
+    return NULL;
+}
+
+const CPUJitBlock* CpuAOTFindBlock(const CPUAOTProgram* program, int32_t key) {
+    size_t low = 0;
+    size_t high = program->count;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (program->blocks[mid].key < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low < program->count && program->blocks[low].key == key) {
+        return &program->blocks[low];
+    }
+    return NULL;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "NesCPUJit.hpp"
+#include "iNesFile.hpp"
+
+#define CPU_AOT_MAX_PROGRAMS            (16)
+
+// nes-aot 工具为一个 ROM 生成的代码，blocks 按 key 升序排列。
+// 生成的 .cpp 加入工程后在静态初始化时调用 CpuAOTRegister，INesInstanceCPUModeJIT 模式下按 PRG ROM 的哈希匹配。
+struct CPUAOTProgram {
+    uint32_t PRGRomHash;
+    size_t PRGRomSize;
+    const CPUJitBlock* blocks;
+    size_t count;
+};
+
+uint32_t CpuAOTHashPRGRom(const uint8_t* data, size_t size);
+bool CpuAOTRegister(const CPUAOTProgram* program);
+const CPUAOTProgram* CpuAOTFindProgram(const INesFile* file);
+const CPUJitBlock* CpuAOTFindBlock(const CPUAOTProgram* program, int32_t key);
@@ -0,0 +1,941 @@
+#pragma once
+
+#include <assert.h>
+#include "NesCPUImpl.hpp"
+
+// 寻址、运算和指令处理函数。除 NesCPUImpl.cpp 外，AOT 生成的代码也直接包含这个头文件，
+// 让编译器可以把整段指令内联展开。
+
+static inline ADDR AddressingStackPoiner(CPU2A03* cpu) {
+    ADDR result = 0x100 | (ADDR)cpu->stackPointer;
+    cpu->lastAddressing = result;
+    return result;
+}
+
+static inline void PushStackByte(CPU2A03* cpu, INesInstance* instance, uint8_t byte) {
+    ADDR addr = AddressingStackPoiner(cpu);
+    INesInstanceWrite(instance, addr, byte);
+    --cpu->stackPointer;
+}
+
+static inline uint8_t PopStackByte(CPU2A03* cpu, INesInstance* instance) {
+    ++cpu->stackPointer;
+    ADDR addr = AddressingStackPoiner(cpu);
+    return INesInstanceRead(instance, addr);
+}
+
+// 以下寻址函数的 operand 为指令的操作数（低字节在前），由 CpuDecodeInstruction 预先取出
+
+// 立即寻址
+static inline uint8_t LoadImmediately(CPU2A03* cpu, INesInstance*, uint16_t operand) {
+    uint8_t result = (uint8_t)operand;
+    cpu->lastAddressing = result;
+    return result;
+}
+
+// 零页寻址
+static inline ADDR AddressingZeroPage(CPU2A03* cpu, INesInstance*, uint16_t operand) {
+    ADDR result = (uint8_t)operand;
+    cpu->lastAddressing = result;
+    return result;
+}
+
+static inline uint8_t LoadZeroPage(CPU2A03* cpu, INesInstance* instance, uint16_t operand) {
+    uint8_t targetAddr = AddressingZeroPage(cpu, instance, operand);
+    return INesInstanceRead(instance, targetAddr);
+}
+
+// 零页X变址
+static inline ADDR AddressingZeroPageIndexX(CPU2A03* cpu, INesInstance*, uint16_t operand) {
+    uint8_t zeroPage = (uint8_t)operand;
+    zeroPage += cpu->registerX;
+    cpu->lastAddressing = zeroPage;
+    return (ADDR)zeroPage;
+}
+
+static inline uint8_t LoadZeroPageIndexX(CPU2A03* cpu, INesInstance* instance, uint16_t operand) {
+    ADDR targetAddr = AddressingZeroPageIndexX(cpu, instance, operand);
+    return INesInstanceRead(instance, targetAddr);
+}
+
+// 零页Y变址
+static inline ADDR AddressingZeroPageIndexY(CPU2A03* cpu, INesInstance*, uint16_t operand) {
+    uint8_t zeroPage = (uint8_t)operand;
+    zeroPage += cpu->registerY;
+    cpu->lastAddressing = zeroPage;
+    return (ADDR)zeroPage;
+}
+
+static inline uint8_t LoadZeroPageIndexY(CPU2A03* cpu, INesInstance* instance, uint16_t operand) {
+    ADDR targetAddr = AddressingZeroPageIndexY(cpu, instance, operand);
+    return INesInstanceRead(instance, targetAddr);
+}
+
+// 绝对寻址
+static inline ADDR AddressingAbsolute(CPU2A03* cpu, INesInstance*, uint16_t operand) {
+    ADDR result = operand;
+    cpu->lastAddressing = result;
+    return result;
+}
+
+// 中断向量
+static inline ADDR AddressingVector(CPU2A03* cpu, INesInstance* instance, ADDR addr) {
+    uint8_t low = INesInstanceRead(instance, addr);
+    uint8_t high = INesInstanceRead(instance, addr + 1);
+    ADDR result = (ADDR)low | ((ADDR)high << 8);
+    cpu->lastAddressing = result;
+    return result;
+}
+
+// 相对寻址
+static inline ADDR AddressingIndirect(CPU2A03* cpu, INesInstance* instance, uint16_t operand) {
+    ADDR jumpAddr = AddressingAbsolute(cpu, instance, operand);
+    ADDR jumpAddr2 = (jumpAddr & 0xff00) | ((jumpAddr+1) & 0xff); // 模拟CPU的bug
+    uint8_t low = INesInstanceRead(instance, jumpAddr);
+    uint8_t high = INesInstanceRead(instance, jumpAddr2);
+    ADDR result = (ADDR)low | ((ADDR)high<<8);
+    cpu->lastAddressing = result;
+    return result;
+}
+
+static inline uint8_t LoadAbsolute(CPU2A03* cpu, INesInstance* instance, uint16_t operand) {
+    ADDR targetAddr = AddressingAbsolute(cpu, instance, operand);
+    return INesInstanceRead(instance, targetAddr);
+}
+
+// 绝对X变址
+static inline ADDR AddressingAbsoluteOffsetX(CPU2A03* cpu, INesInstance*, uint16_t operand) {
+    uint8_t high = (uint8_t)(operand >> 8);
+    ADDR targetAddr = operand;
+    targetAddr += cpu->registerX;
+    cpu->crossPageCycle = high != (uint8_t)(targetAddr >> 8);
+    cpu->lastAddressing = targetAddr;
+    return targetAddr;
+}
+
+static inline uint8_t LoadAbsoluteOffsetX(CPU2A03* cpu, INesInstance* instance, uint16_t operand) {
+    ADDR targetAddr = AddressingAbsoluteOffsetX(cpu, instance, operand);
+    return INesInstanceRead(instance, targetAddr);
+}
+
+// 绝对Y变址
+static inline ADDR AddressingAbsoluteOffsetY(CPU2A03* cpu, INesInstance*, uint16_t operand) {
+    uint8_t high = (uint8_t)(operand >> 8);
+    ADDR targetAddr = operand;
+    targetAddr += cpu->registerY;
+    cpu->crossPageCycle = high != (uint8_t)(targetAddr >> 8);
+    cpu->lastAddressing = targetAddr;
+    return targetAddr;
+}
+
+static inline uint8_t LoadAbsoluteOffsetY(CPU2A03* cpu, INesInstance* instance, uint16_t operand) {
+    ADDR targetAddr = AddressingAbsoluteOffsetY(cpu, instance, operand);
+    return INesInstanceRead(instance, targetAddr);
+}
+
+// 变址间接
+static inline ADDR AddressingPreIndirectX(CPU2A03* cpu, INesInstance* instance, uint16_t operand) {
+    uint8_t tmp = (uint8_t)operand;
+    tmp += cpu->registerX;
+    uint8_t low = INesInstanceRead(instance, tmp);
+    tmp += 1;
+    uint8_t high = INesInstanceRead(instance, tmp);
+    ADDR result = ((ADDR)high << 8) | (ADDR)low;
+    cpu->lastAddressing = result;
+    return result;
+}
+
+static inline uint8_t LoadPreIndirectX(CPU2A03* cpu, INesInstance* instance, uint16_t operand) {
+    ADDR targetAddr = AddressingPreIndirectX(cpu, instance, operand);
+    return INesInstanceRead(instance, targetAddr);
+}
+
+// 间接变址
+static inline ADDR AddressingPostIndirectY(CPU2A03* cpu, INesInstance* instance, uint16_t operand) {
+    uint8_t tmp = (uint8_t)operand;
+    uint8_t low = INesInstanceRead(instance, tmp);
+    tmp += 1;
+    uint8_t high = INesInstanceRead(instance, tmp);
+    ADDR targetAddr = (high << 8) | low;
+    targetAddr += cpu->registerY;
+    cpu->crossPageCycle = high != (targetAddr >> 8);
+    cpu->lastAddressing = targetAddr;
+    return targetAddr;
+}
+
+static inline uint8_t LoadPostIndirectY(CPU2A03* cpu, INesInstance* instance, uint16_t operand) {
+    ADDR targetAddr = AddressingPostIndirectY(cpu, instance, operand);
+    return INesInstanceRead(instance, targetAddr);
+}
+
+// 只记录结果，分支、PHP 或中断需要时才计算 N/Z
+static inline void SetFlagZN(CPU2A03* cpu, int8_t n) {
+    cpu->flagNZ = (uint8_t)n;
+}
+
+static inline void CpuExecuteADC(CPU2A03* cpu, uint8_t op) {
+    uint8_t ua = cpu->registerA;
+    uint8_t ub = op;
+    uint8_t uc = cpu->flagC;
+    int8_t sa = (int8_t)ua;
+    int8_t sb = (int8_t)ub;
+    int8_t sc = (int8_t)uc;
+    uint16_t uSum16 = (uint16_t)ua + (uint16_t)ub + (uint16_t)uc;
+    int16_t sSum16 = (int16_t)sa + (int16_t)sb + (int16_t)sc;
+    int8_t sSum8 = sa + sb + sc;
+    uint8_t uSum8 = ua + ub + uc;
+    cpu->registerA = uSum8;
+    cpu->flagC = (uSum16 > 0xff) ? 1 : 0;
+    cpu->flagV = ((sSum16 > 0 && sSum8 < 0) || (sSum16 < 0 && sSum8 > 0)) ? 1 : 0;
+    SetFlagZN(cpu, (int8_t)uSum8);
+}
+
+static inline void CpuExecuteSBC(CPU2A03* cpu, uint8_t op) {
+    uint8_t ua = cpu->registerA;
+    uint8_t ub = op;
+    uint8_t uc = cpu->flagC == 1 ? 0 : 1;
+    int8_t sa = (int8_t)ua;
+    int8_t sb = (int8_t)ub;
+    int8_t sc = (int8_t)uc;
+    uint16_t uSub16 = (uint16_t)ua - (uint16_t)ub - (uint16_t)uc;
+    int16_t sSub16 = (int16_t)sa - (int16_t)sb - (int16_t)sc;
+    int8_t sSub8 = sa - sb - sc;
+    uint8_t uSub8 = ua - ub - uc;
+    cpu->registerA = uSub8;
+    cpu->flagC = (((int16_t)uSub16) < 0) ? 0 : 1;
+    cpu->flagV = ((sSub16 > 0 && sSub8 < 0) || (sSub16 < 0 && sSub8 > 0)) ? 1 : 0;
+    SetFlagZN(cpu, (int8_t)uSub8);
+}
+
+static inline void CpuExecuteINC(CPU2A03* cpu, INesInstance* instance, ADDR addr) {
+    INesInstanceInc(instance, addr);
+    int8_t n = (int8_t)INesInstanceRead(instance, addr);
+    SetFlagZN(cpu, n);
+}
+
+static inline void CpuExecuteDEC(CPU2A03* cpu, INesInstance* instance, ADDR addr) {
+    INesInstanceDec(instance, addr);
+    int8_t n = (int8_t)INesInstanceRead(instance, addr);
+    SetFlagZN(cpu, n);
+}
+
+static inline void CpuExecuteINX(CPU2A03* cpu) {
+    cpu->registerX += 1;
+    SetFlagZN(cpu, (int8_t)cpu->registerX);
+}
+
+static inline void CpuExecuteINY(CPU2A03* cpu) {
+    cpu->registerY += 1;
+    SetFlagZN(cpu, (int8_t)cpu->registerY);
+}
+
+static inline void CpuExecuteDEX(CPU2A03* cpu) {
+    cpu->registerX -= 1;
+    SetFlagZN(cpu, (int8_t)cpu->registerX);
+}
+
+static inline void CpuExecuteDEY(CPU2A03* cpu) {
+    cpu->registerY -= 1;
+    SetFlagZN(cpu, (int8_t)cpu->registerY);
+}
+
+static inline void CpuExecuteAND(CPU2A03* cpu, uint8_t op) {
+    cpu->registerA &= op;
+    SetFlagZN(cpu, (int8_t)cpu->registerA);
+}
+
+static inline void CpuExecuteXOR(CPU2A03* cpu, uint8_t op) {
+    cpu->registerA ^= op;
+    SetFlagZN(cpu, (int8_t)cpu->registerA);
+}
+
+static inline void CpuExecuteOR(CPU2A03* cpu, uint8_t op) {
+    cpu->registerA |= op;
+    SetFlagZN(cpu, (int8_t)cpu->registerA);
+}
+
+static inline void CpuExecuteBIT(CPU2A03* cpu, uint8_t op) {
+    // N 取自操作数的 bit 7，放在 bit 8 以免影响 Z
+    cpu->flagNZ = (uint16_t)(cpu->registerA & op) | ((uint16_t)(op & 0x80) << 1);
+    cpu->flagV = (op >> 6) & 1;
+}
+
+static inline uint8_t CpuExecuteASL(CPU2A03* cpu, INesInstance* instance, ADDR addr) {
+    uint8_t op = INesInstanceRead(instance, addr);
+    cpu->flagC = (op & 0x80) ? 1 : 0;
+    op <<= 1;
+    SetFlagZN(cpu, (int8_t)op);
+    INesInstanceWrite(instance, addr, op);
+    return op;
+}
+
+static inline void CpuExecuteAccumulatorASL(CPU2A03* cpu) {
+    uint8_t op = cpu->registerA;
+    cpu->flagC = (op & 0x80) ? 1 : 0;
+    op <<= 1;
+    SetFlagZN(cpu, (int8_t)op);
+    cpu->registerA = op;
+}
+
+static inline uint8_t CpuExecuteLSR(CPU2A03* cpu, INesInstance* instance, ADDR addr) {
+    uint8_t op = INesInstanceRead(instance, addr);
+    cpu->flagC = (op & 0x01) ? 1 : 0;
+    op >>= 1;
+    SetFlagZN(cpu, (int8_t)op);
+    INesInstanceWrite(instance, addr, op);
+    return op;
+}
+
+static inline void CpuExecuteAccumulatorLSR(CPU2A03* cpu) {
+    uint8_t op = cpu->registerA;
+    cpu->flagC = (op & 0x01) ? 1 : 0;
+    op >>= 1;
+    SetFlagZN(cpu, (int8_t)op);
+    cpu->registerA = op;
+}
+
+static inline uint8_t CpuExecuteROL(CPU2A03* cpu, INesInstance* instance, ADDR addr) {
+    uint8_t op = INesInstanceRead(instance, addr);
+    uint8_t tmp = (op >> 7);
+    op = (op << 1) | cpu->flagC;
+    cpu->flagC = tmp;
+    SetFlagZN(cpu, (int8_t)op);
+    INesInstanceWrite(instance, addr, op);
+    return op;
+}
+
+static inline void CpuExecuteAccumulatorROL(CPU2A03* cpu) {
+    uint8_t op = cpu->registerA;
+    uint8_t tmp = (op >> 7);
+    op = (op << 1) | cpu->flagC;
+    cpu->flagC = tmp;
+    SetFlagZN(cpu, (int8_t)op);
+    cpu->registerA = op;
+}
+
+static inline uint8_t CpuExecuteROR(CPU2A03* cpu, INesInstance* instance, ADDR addr) {
+    uint8_t op = INesInstanceRead(instance, addr);
+    uint8_t tmp = op & 0x01;
+    op = (op >> 1) | (cpu->flagC << 7);
+    cpu->flagC = tmp;
+    SetFlagZN(cpu, (int8_t)op);
+    INesInstanceWrite(instance, addr, op);
+    return op;
+}
+
+static inline void CpuExecuteAccumulatorROR(CPU2A03* cpu) {
+    uint8_t op = cpu->registerA;
+    uint8_t tmp = op & 0x01;
+    op = (op >> 1) | (cpu->flagC << 7);
+    cpu->flagC = tmp;
+    SetFlagZN(cpu, (int8_t)op);
+    cpu->registerA = op;
+}
+
+static inline void CpuExecuteCMP_A_B(CPU2A03* cpu, uint8_t a, uint8_t b) {
+    SetFlagZN(cpu, (int8_t)(a - b));
+    cpu->flagC = a >= b ? 1 : 0;
+}
+
+static inline void CpuExecuteCMP(CPU2A03* cpu, uint8_t op) {
+    CpuExecuteCMP_A_B(cpu, cpu->registerA, op);
+}
+
+static inline void CpuExecuteSetRegisterA(CPU2A03* cpu, uint8_t op) {
+    cpu->registerA = op;
+    SetFlagZN(cpu, (int8_t)op);
+}
+
+static inline void CpuExecuteSetRegisterX(CPU2A03* cpu, uint8_t op) {
+    cpu->registerX = op;
+    SetFlagZN(cpu, (int8_t)op);
+}
+
+static inline void CpuExecuteSetRegisterY(CPU2A03* cpu, uint8_t op) {
+    cpu->registerY = op;
+    SetFlagZN(cpu, (int8_t)op);
+}
+
+static inline void CpuExecuteStoreRegisterA(CPU2A03* cpu, INesInstance* instance, ADDR addr) {
+    INesInstanceWrite(instance, addr, cpu->registerA);
+}
+
+static inline void CpuExecuteStoreRegisterX(CPU2A03* cpu, INesInstance* instance, ADDR addr) {
+    INesInstanceWrite(instance, addr, cpu->registerX);
+}
+
+static inline void CpuExecuteStoreRegisterY(CPU2A03* cpu, INesInstance* instance, ADDR addr) {
+    INesInstanceWrite(instance, addr, cpu->registerY);
+}
+
+static inline void CpuExecuteLAX(CPU2A03* cpu, uint8_t op) {
+    cpu->registerA = op;
+    cpu->registerX = op;
+    SetFlagZN(cpu, (int8_t)op);
+}
+
+static inline void CpuExecuteSAX(CPU2A03* cpu, INesInstance* instance, ADDR addr) {
+    uint8_t r = cpu->registerA & cpu->registerX;
+    INesInstanceWrite(instance, addr, r);
+}
+
+static inline void CpuExecuteDCP(CPU2A03* cpu, INesInstance* instance, ADDR addr) {
+    uint8_t value = INesInstanceRead(instance, addr) - 1;
+    INesInstanceWrite(instance, addr, value);
+    CpuExecuteCMP_A_B(cpu, cpu->registerA, value);
+}
+
+static inline void CpuExecuteISB(CPU2A03* cpu, INesInstance* instance, ADDR addr) {
+    uint8_t value = INesInstanceRead(instance, addr) + 1;
+    INesInstanceWrite(instance, addr, value);
+    CpuExecuteSBC(cpu, value);
+}
+
+static inline void CpuExecuteSLO(CPU2A03* cpu, INesInstance* instance, ADDR addr) {
+    uint8_t op = CpuExecuteASL(cpu, instance, addr);
+    CpuExecuteOR(cpu, op);
+}
+
+static inline void CpuExecuteRLA(CPU2A03* cpu, INesInstance* instance, ADDR addr) {
+    uint8_t op = CpuExecuteROL(cpu, instance, addr);
+    CpuExecuteAND(cpu, op);
+}
+
+static inline void CpuExecuteSRE(CPU2A03* cpu, INesInstance* instance, ADDR addr) {
+    uint8_t op = CpuExecuteLSR(cpu, instance, addr);
+    CpuExecuteXOR(cpu, op);
+}
+
+static inline void CpuExecuteRRA(CPU2A03* cpu, INesInstance* instance, ADDR addr) {
+    uint8_t op = CpuExecuteROR(cpu, instance, addr);
+    CpuExecuteADC(cpu, op);
+}
+
+static inline void CpuExecuteCPX(CPU2A03* cpu, uint8_t op) {
+    CpuExecuteCMP_A_B(cpu, cpu->registerX, op);
+}
+
+static inline void CpuExecuteCPY(CPU2A03* cpu, uint8_t op) {
+    CpuExecuteCMP_A_B(cpu, cpu->registerY, op);
+}
+
+static inline void CpuExecuteCLC(CPU2A03* cpu) {
+    cpu->flagC = 0;
+}
+
+static inline void CpuExecuteCLD(CPU2A03* cpu) {
+    cpu->flag.D = 0;
+}
+
+static inline void CpuExecuteCLI(CPU2A03* cpu) {
+    cpu->flag.I = 0;
+}
+
+static inline void CpuExecuteCLV(CPU2A03* cpu) {
+    cpu->flagV = 0;
+}
+
+static inline void CpuExecuteSEC(CPU2A03* cpu) {
+    cpu->flagC = 1;
+}
+
+static inline void CpuExecuteSED(CPU2A03* cpu) {
+    cpu->flag.D = 1;
+}
+
+static inline void CpuExecuteSEI(CPU2A03* cpu) {
+    cpu->flag.I = 1;
+}
+
+static inline void CpuExecuteTAX(CPU2A03* cpu) {
+    cpu->registerX = cpu->registerA;
+    SetFlagZN(cpu, (int8_t)cpu->registerX);
+}
+
+static inline void CpuExecuteTAY(CPU2A03* cpu) {
+    cpu->registerY = cpu->registerA;
+    SetFlagZN(cpu, (int8_t)cpu->registerY);
+}
+
+static inline void CpuExecuteTSX(CPU2A03* cpu) {
+    cpu->registerX = cpu->stackPointer;
+    SetFlagZN(cpu, (int8_t)cpu->registerX);
+}
+
+static inline void CpuExecuteTXA(CPU2A03* cpu) {
+    cpu->registerA = cpu->registerX;
+    SetFlagZN(cpu, (int8_t)cpu->registerA);
+}
+
+static inline void CpuExecuteTXS(CPU2A03* cpu) {
+    cpu->stackPointer = cpu->registerX;
+}
+
+static inline void CpuExecuteTYA(CPU2A03* cpu) {
+    cpu->registerA = cpu->registerY;
+    SetFlagZN(cpu, (int8_t)cpu->registerA);
+}
+
+static inline void CpuExecutePHA(CPU2A03* cpu, INesInstance* instance) {
+    PushStackByte(cpu, instance, cpu->registerA);
+}
+
+static inline void CpuExecutePHP(CPU2A03* cpu, INesInstance* instance) {
+    PushStackFlag(cpu, instance);
+}
+
+static inline void CpuExecutePLA(CPU2A03* cpu, INesInstance* instance) {
+    cpu->registerA = PopStackByte(cpu, instance);
+    SetFlagZN(cpu, (int8_t)cpu->registerA);
+}
+
+static inline void CpuExecutePLP(CPU2A03* cpu, INesInstance* instance) {
+    PopStackFlag(cpu, instance);
+}
+
+static inline void CpuExecuteNOP(CPU2A03*, INesInstance*, ADDR) {
+}
+
+// 寻址模式，size 为指令长度
+struct CpuModeImmediately {
+    static const uint8_t size = 2;
+    static uint8_t Load(CPU2A03* cpu, INesInstance* instance, uint16_t operand) { return LoadImmediately(cpu, instance, operand); }
+};
+
+struct CpuModeZeroPage {
+    static const uint8_t size = 2;
+    static ADDR Addressing(CPU2A03* cpu, INesInstance* instance, uint16_t operand) { return AddressingZeroPage(cpu, instance, operand); }
+    static uint8_t Load(CPU2A03* cpu, INesInstance* instance, uint16_t operand) { return LoadZeroPage(cpu, instance, operand); }
+};
+
+struct CpuModeZeroPageIndexX {
+    static const uint8_t size = 2;
+    static ADDR Addressing(CPU2A03* cpu, INesInstance* instance, uint16_t operand) { return AddressingZeroPageIndexX(cpu, instance, operand); }
+    static uint8_t Load(CPU2A03* cpu, INesInstance* instance, uint16_t operand) { return LoadZeroPageIndexX(cpu, instance, operand); }
+};
+
+struct CpuModeZeroPageIndexY {
+    static const uint8_t size = 2;
+    static ADDR Addressing(CPU2A03* cpu, INesInstance* instance, uint16_t operand) { return AddressingZeroPageIndexY(cpu, instance, operand); }
+    static uint8_t Load(CPU2A03* cpu, INesInstance* instance, uint16_t operand) { return LoadZeroPageIndexY(cpu, instance, operand); }
+};
+
+struct CpuModeAbsolute {
+    static const uint8_t size = 3;
+    static ADDR Addressing(CPU2A03* cpu, INesInstance* instance, uint16_t operand) { return AddressingAbsolute(cpu, instance, operand); }
+    static uint8_t Load(CPU2A03* cpu, INesInstance* instance, uint16_t operand) { return LoadAbsolute(cpu, instance, operand); }
+};
+
+struct CpuModeAbsoluteOffsetX {
+    static const uint8_t size = 3;
+    static ADDR Addressing(CPU2A03* cpu, INesInstance* instance, uint16_t operand) { return AddressingAbsoluteOffsetX(cpu, instance, operand); }
+    static uint8_t Load(CPU2A03* cpu, INesInstance* instance, uint16_t operand) { return LoadAbsoluteOffsetX(cpu, instance, operand); }
+};
+
+struct CpuModeAbsoluteOffsetY {
+    static const uint8_t size = 3;
+    static ADDR Addressing(CPU2A03* cpu, INesInstance* instance, uint16_t operand) { return AddressingAbsoluteOffsetY(cpu, instance, operand); }
+    static uint8_t Load(CPU2A03* cpu, INesInstance* instance, uint16_t operand) { return LoadAbsoluteOffsetY(cpu, instance, operand); }
+};
+
+struct CpuModePreIndirectX {
+    static const uint8_t size = 2;
+    static ADDR Addressing(CPU2A03* cpu, INesInstance* instance, uint16_t operand) { return AddressingPreIndirectX(cpu, instance, operand); }
+    static uint8_t Load(CPU2A03* cpu, INesInstance* instance, uint16_t operand) { return LoadPreIndirectX(cpu, instance, operand); }
+};
+
+struct CpuModePostIndirectY {
+    static const uint8_t size = 2;
+    static ADDR Addressing(CPU2A03* cpu, INesInstance* instance, uint16_t operand) { return AddressingPostIndirectY(cpu, instance, operand); }
+    static uint8_t Load(CPU2A03* cpu, INesInstance* instance, uint16_t operand) { return LoadPostIndirectY(cpu, instance, operand); }
+};
+
+// 指令处理函数由 (操作 x 寻址模式) 模板生成，addr 为指令所在地址，operand 为预先取出的操作数
+
+// 读操作数
+template <auto Op, typename Mode>
+static inline void CpuHandlerRead(CPU2A03* cpu, INesInstance* instance, ADDR addr, uint16_t operand) {
+    uint8_t op = Mode::Load(cpu, instance, operand);
+    Op(cpu, op);
+    cpu->pc = addr + Mode::size;
+}
+
+// 写或读改写目标地址
+template <auto Op, typename Mode>
+static inline void CpuHandlerModify(CPU2A03* cpu, INesInstance* instance, ADDR addr, uint16_t operand) {
+    ADDR targetAddr = Mode::Addressing(cpu, instance, operand);
+    Op(cpu, instance, targetAddr);
+    cpu->pc = addr + Mode::size;
+}
+
+template <auto Op>
+static inline void CpuHandlerImplied(CPU2A03* cpu, INesInstance*, ADDR addr, uint16_t) {
+    Op(cpu);
+    cpu->pc = addr + 1;
+}
+
+template <auto Op>
+static inline void CpuHandlerStack(CPU2A03* cpu, INesInstance* instance, ADDR addr, uint16_t) {
+    Op(cpu, instance);
+    cpu->pc = addr + 1;
+}
+
+// 不访问内存的 NOP
+template <uint8_t Size>
+static inline void CpuHandlerSkip(CPU2A03* cpu, INesInstance*, ADDR addr, uint16_t) {
+    cpu->pc = addr + Size;
+}
+
+static inline bool CpuConditionCC(const CPU2A03* cpu) { return cpu->flagC == 0; }
+static inline bool CpuConditionCS(const CPU2A03* cpu) { return cpu->flagC; }
+static inline bool CpuConditionNE(const CPU2A03* cpu) { return !CpuFlagZ(cpu); }
+static inline bool CpuConditionEQ(const CPU2A03* cpu) { return CpuFlagZ(cpu); }
+static inline bool CpuConditionPL(const CPU2A03* cpu) { return !CpuFlagN(cpu); }
+static inline bool CpuConditionMI(const CPU2A03* cpu) { return CpuFlagN(cpu); }
+static inline bool CpuConditionVC(const CPU2A03* cpu) { return cpu->flagV == 0; }
+static inline bool CpuConditionVS(const CPU2A03* cpu) { return cpu->flagV; }
+
+template <bool (*Condition)(const CPU2A03*)>
+static inline void CpuHandlerBranch(CPU2A03* cpu, INesInstance* instance, ADDR addr, uint16_t operand) {
+    if (Condition(cpu)) {
+        auto op = (int8_t)LoadImmediately(cpu, instance, operand);
+        cpu->pc = addr + 2 + op;
+        cpu->crossPageCycle = (uint8_t)(cpu->pc >> 8) != (uint8_t)((addr + 2) >> 8) ? 2 : 1;
+    } else {
+        cpu->pc = addr + 2;
+    }
+}
+
+static inline void CpuHandlerBRK(CPU2A03* cpu, INesInstance* instance, ADDR addr, uint16_t) {
+    PushStackWord(cpu, instance, addr + 2);
+    PushStackFlag(cpu, instance);
+    cpu->flag.B = 1;
+    cpu->flag.I = 1;
+    cpu->pc = AddressingVector(cpu, instance, BRK_JUMP_ADDRESS);
+}
+
+static inline void CpuHandlerJMPAbsolute(CPU2A03* cpu, INesInstance* instance, ADDR, uint16_t operand) {
+    cpu->pc = AddressingAbsolute(cpu, instance, operand);
+}
+
+static inline void CpuHandlerJMPIndirect(CPU2A03* cpu, INesInstance* instance, ADDR, uint16_t operand) {
+    cpu->pc = AddressingIndirect(cpu, instance, operand);
+}
+
+static inline void CpuHandlerJSR(CPU2A03* cpu, INesInstance* instance, ADDR addr, uint16_t operand) {
+    ADDR targetAddr = AddressingAbsolute(cpu, instance, operand);
+    PushStackWord(cpu, instance, addr + 2);
+    cpu->pc = targetAddr;
+}
+
+static inline void CpuHandlerRTI(CPU2A03* cpu, INesInstance* instance, ADDR, uint16_t) {
+    PopStackFlag(cpu, instance);
+    cpu->pc = PopStackWord(cpu, instance);
+}
+
+static inline void CpuHandlerRTS(CPU2A03* cpu, INesInstance* instance, ADDR, uint16_t) {
+    cpu->pc = PopStackWord(cpu, instance) + 1;
+}
+
+static inline void CpuHandlerInvalid(CPU2A03* cpu, INesInstance*, ADDR, uint16_t) {
+    cpu->pc = 0;
+    assert(false);
+}
+
+// X(opcode, handler)
+#define CPU_HANDLER_LIST(X) \
+    /* ADC */ \
+    X(CORE_CODE_ADC_IMMD,          (CpuHandlerRead<CpuExecuteADC, CpuModeImmediately>)) \
+    X(CORE_CODE_ADC_ZEROPAGE,      (CpuHandlerRead<CpuExecuteADC, CpuModeZeroPage>)) \
+    X(CORE_CODE_ADC_ZEROPAGEIX,    (CpuHandlerRead<CpuExecuteADC, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_ADC_ABSOLUTE,      (CpuHandlerRead<CpuExecuteADC, CpuModeAbsolute>)) \
+    X(CORE_CODE_ADC_ABSOLUTEIX,    (CpuHandlerRead<CpuExecuteADC, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_ADC_ABSOLUTEIY,    (CpuHandlerRead<CpuExecuteADC, CpuModeAbsoluteOffsetY>)) \
+    X(CORE_CODE_ADC_PREIDX,        (CpuHandlerRead<CpuExecuteADC, CpuModePreIndirectX>)) \
+    X(CORE_CODE_ADC_POSTIDY,       (CpuHandlerRead<CpuExecuteADC, CpuModePostIndirectY>)) \
+    /* INC */ \
+    X(CORE_CODE_INC_ZEROPAGE,      (CpuHandlerModify<CpuExecuteINC, CpuModeZeroPage>)) \
+    X(CORE_CODE_INC_ZEROPAGE_IDX,  (CpuHandlerModify<CpuExecuteINC, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_INC_ABSOLUTE,      (CpuHandlerModify<CpuExecuteINC, CpuModeAbsolute>)) \
+    X(CORE_CODE_INC_ABSOLUTE_IDX,  (CpuHandlerModify<CpuExecuteINC, CpuModeAbsoluteOffsetX>)) \
+    /* INX */ \
+    X(CORE_CODE_INX,               (CpuHandlerImplied<CpuExecuteINX>)) \
+    /* INY */ \
+    X(CORE_CODE_INY,               (CpuHandlerImplied<CpuExecuteINY>)) \
+    /* SBC */ \
+    X(CORE_CODE_SBC_IMMD,          (CpuHandlerRead<CpuExecuteSBC, CpuModeImmediately>)) \
+    X(CORE_CODE_SBC_ZEROPAGE,      (CpuHandlerRead<CpuExecuteSBC, CpuModeZeroPage>)) \
+    X(CORE_CODE_SBC_ZEROPAGE_IDX,  (CpuHandlerRead<CpuExecuteSBC, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_SBC_ABSOLUTE,      (CpuHandlerRead<CpuExecuteSBC, CpuModeAbsolute>)) \
+    X(CORE_CODE_SBC_ABSOLUTEIX,    (CpuHandlerRead<CpuExecuteSBC, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_SBC_ABSOLUTEIY,    (CpuHandlerRead<CpuExecuteSBC, CpuModeAbsoluteOffsetY>)) \
+    X(CORE_CODE_SBC_PREIDX,        (CpuHandlerRead<CpuExecuteSBC, CpuModePreIndirectX>)) \
+    X(CORE_CODE_SBC_POSTIDY,       (CpuHandlerRead<CpuExecuteSBC, CpuModePostIndirectY>)) \
+    /* DEC */ \
+    X(CORE_CODE_DEC_ZEROPAGE,      (CpuHandlerModify<CpuExecuteDEC, CpuModeZeroPage>)) \
+    X(CORE_CODE_DEC_ZEROPAGE_IDX,  (CpuHandlerModify<CpuExecuteDEC, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_DEC_ABSOLUTE,      (CpuHandlerModify<CpuExecuteDEC, CpuModeAbsolute>)) \
+    X(CORE_CODE_DEC_ABSOLUTE_IDX,  (CpuHandlerModify<CpuExecuteDEC, CpuModeAbsoluteOffsetX>)) \
+    /* DEX */ \
+    X(CORE_CODE_DEX,               (CpuHandlerImplied<CpuExecuteDEX>)) \
+    /* DEY */ \
+    X(CORE_CODE_DEY,               (CpuHandlerImplied<CpuExecuteDEY>)) \
+    /* AND */ \
+    X(CORE_CODE_AND_IMMD,          (CpuHandlerRead<CpuExecuteAND, CpuModeImmediately>)) \
+    X(CORE_CODE_AND_ZEROPAGE,      (CpuHandlerRead<CpuExecuteAND, CpuModeZeroPage>)) \
+    X(CORE_CODE_AND_ZEROPAGE_IDX,  (CpuHandlerRead<CpuExecuteAND, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_AND_ABSOLUTE,      (CpuHandlerRead<CpuExecuteAND, CpuModeAbsolute>)) \
+    X(CORE_CODE_AND_ABSOLUTEIX,    (CpuHandlerRead<CpuExecuteAND, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_AND_ABSOLUTEIY,    (CpuHandlerRead<CpuExecuteAND, CpuModeAbsoluteOffsetY>)) \
+    X(CORE_CODE_AND_PREIDX,        (CpuHandlerRead<CpuExecuteAND, CpuModePreIndirectX>)) \
+    X(CORE_CODE_AND_POSTIDY,       (CpuHandlerRead<CpuExecuteAND, CpuModePostIndirectY>)) \
+    /* EOR */ \
+    X(CORE_CODE_EOR_IMMD,          (CpuHandlerRead<CpuExecuteXOR, CpuModeImmediately>)) \
+    X(CORE_CODE_EOR_ZEROPAGE,      (CpuHandlerRead<CpuExecuteXOR, CpuModeZeroPage>)) \
+    X(CORE_CODE_EOR_ZEROPAGE_IDX,  (CpuHandlerRead<CpuExecuteXOR, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_EOR_ABSOLUTE,      (CpuHandlerRead<CpuExecuteXOR, CpuModeAbsolute>)) \
+    X(CORE_CODE_EOR_ABSOLUTEIX,    (CpuHandlerRead<CpuExecuteXOR, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_EOR_ABSOLUTEIY,    (CpuHandlerRead<CpuExecuteXOR, CpuModeAbsoluteOffsetY>)) \
+    X(CORE_CODE_EOR_PREIDX,        (CpuHandlerRead<CpuExecuteXOR, CpuModePreIndirectX>)) \
+    X(CORE_CODE_EOR_POSTIDY,       (CpuHandlerRead<CpuExecuteXOR, CpuModePostIndirectY>)) \
+    /* ORA */ \
+    X(CORE_CODE_ORA_IMMD,          (CpuHandlerRead<CpuExecuteOR, CpuModeImmediately>)) \
+    X(CORE_CODE_ORA_ZEROPAGE,      (CpuHandlerRead<CpuExecuteOR, CpuModeZeroPage>)) \
+    X(CORE_CODE_ORA_ZEROPAGE_IDX,  (CpuHandlerRead<CpuExecuteOR, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_ORA_ABSOLUTE,      (CpuHandlerRead<CpuExecuteOR, CpuModeAbsolute>)) \
+    X(CORE_CODE_ORA_ABSOLUTEIX,    (CpuHandlerRead<CpuExecuteOR, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_ORA_ABSOLUTEIY,    (CpuHandlerRead<CpuExecuteOR, CpuModeAbsoluteOffsetY>)) \
+    X(CORE_CODE_ORA_PREIDX,        (CpuHandlerRead<CpuExecuteOR, CpuModePreIndirectX>)) \
+    X(CORE_CODE_ORA_POSTIDY,       (CpuHandlerRead<CpuExecuteOR, CpuModePostIndirectY>)) \
+    /* BIT */ \
+    X(CORE_CODE_BIT_ZEROPAGE,      (CpuHandlerRead<CpuExecuteBIT, CpuModeZeroPage>)) \
+    X(CORE_CODE_BIT_ABSOLUTE,      (CpuHandlerRead<CpuExecuteBIT, CpuModeAbsolute>)) \
+    /* ASL */ \
+    X(CORE_CODE_ASL_REGISTER,      (CpuHandlerImplied<CpuExecuteAccumulatorASL>)) \
+    X(CORE_CODE_ASL_ZEROPAGE,      (CpuHandlerModify<CpuExecuteASL, CpuModeZeroPage>)) \
+    X(CORE_CODE_ASL_ZEROPAGE_IDX,  (CpuHandlerModify<CpuExecuteASL, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_ASL_ABSOLUTE,      (CpuHandlerModify<CpuExecuteASL, CpuModeAbsolute>)) \
+    X(CORE_CODE_ASL_ABSOLUTEIX,    (CpuHandlerModify<CpuExecuteASL, CpuModeAbsoluteOffsetX>)) \
+    /* LSR */ \
+    X(CORE_CODE_LSR_REGISTER,      (CpuHandlerImplied<CpuExecuteAccumulatorLSR>)) \
+    X(CORE_CODE_LSR_ZEROPAGE,      (CpuHandlerModify<CpuExecuteLSR, CpuModeZeroPage>)) \
+    X(CORE_CODE_LSR_ZEROPAGE_IDX,  (CpuHandlerModify<CpuExecuteLSR, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_LSR_ABSOLUTE,      (CpuHandlerModify<CpuExecuteLSR, CpuModeAbsolute>)) \
+    X(CORE_CODE_LSR_ABSOLUTEIX,    (CpuHandlerModify<CpuExecuteLSR, CpuModeAbsoluteOffsetX>)) \
+    /* ROL */ \
+    X(CORE_CODE_ROL_REGISTER,      (CpuHandlerImplied<CpuExecuteAccumulatorROL>)) \
+    X(CORE_CODE_ROL_ZEROPAGE,      (CpuHandlerModify<CpuExecuteROL, CpuModeZeroPage>)) \
+    X(CORE_CODE_ROL_ZEROPAGE_IDX,  (CpuHandlerModify<CpuExecuteROL, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_ROL_ABSOLUTE,      (CpuHandlerModify<CpuExecuteROL, CpuModeAbsolute>)) \
+    X(CORE_CODE_ROL_ABSOLUTEIX,    (CpuHandlerModify<CpuExecuteROL, CpuModeAbsoluteOffsetX>)) \
+    /* ROR */ \
+    X(CORE_CODE_ROR_REGISTER,      (CpuHandlerImplied<CpuExecuteAccumulatorROR>)) \
+    X(CORE_CODE_ROR_ZEROPAGE,      (CpuHandlerModify<CpuExecuteROR, CpuModeZeroPage>)) \
+    X(CORE_CODE_ROR_ZEROPAGE_IDX,  (CpuHandlerModify<CpuExecuteROR, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_ROR_ABSOLUTE,      (CpuHandlerModify<CpuExecuteROR, CpuModeAbsolute>)) \
+    X(CORE_CODE_ROR_ABSOLUTEIX,    (CpuHandlerModify<CpuExecuteROR, CpuModeAbsoluteOffsetX>)) \
+    /* BCC */ \
+    X(CORE_CODE_BCC,               (CpuHandlerBranch<CpuConditionCC>)) \
+    /* BCS */ \
+    X(CORE_CODE_BCS,               (CpuHandlerBranch<CpuConditionCS>)) \
+    /* BEQ */ \
+    X(CORE_CODE_BEQ,               (CpuHandlerBranch<CpuConditionEQ>)) \
+    /* BMI */ \
+    X(CORE_CODE_BMI,               (CpuHandlerBranch<CpuConditionMI>)) \
+    /* BNE */ \
+    X(CORE_CODE_BNE,               (CpuHandlerBranch<CpuConditionNE>)) \
+    /* BPL */ \
+    X(CORE_CODE_BPL,               (CpuHandlerBranch<CpuConditionPL>)) \
+    /* BVC */ \
+    X(CORE_CODE_BVC,               (CpuHandlerBranch<CpuConditionVC>)) \
+    /* BVS */ \
+    X(CORE_CODE_BVS,               (CpuHandlerBranch<CpuConditionVS>)) \
+    /* BRK */ \
+    X(CORE_CODE_BRK,               (CpuHandlerBRK)) \
+    /* JMP */ \
+    X(CORE_CODE_JMP_ABSOLUTE,      (CpuHandlerJMPAbsolute)) \
+    X(CORE_CODE_JMP_INDIRECT,      (CpuHandlerJMPIndirect)) \
+    /* JSR */ \
+    X(CORE_CODE_JSR,               (CpuHandlerJSR)) \
+    /* RTI */ \
+    X(CORE_CODE_RTI,               (CpuHandlerRTI)) \
+    /* RTS */ \
+    X(CORE_CODE_RTS,               (CpuHandlerRTS)) \
+    /* CLC */ \
+    X(CORE_CODE_CLC,               (CpuHandlerImplied<CpuExecuteCLC>)) \
+    /* CLD */ \
+    X(CORE_CODE_CLD,               (CpuHandlerImplied<CpuExecuteCLD>)) \
+    /* CLI */ \
+    X(CORE_CODE_CLI,               (CpuHandlerImplied<CpuExecuteCLI>)) \
+    /* CLV */ \
+    X(CORE_CODE_CLV,               (CpuHandlerImplied<CpuExecuteCLV>)) \
+    /* SEC */ \
+    X(CORE_CODE_SEC,               (CpuHandlerImplied<CpuExecuteSEC>)) \
+    /* SED */ \
+    X(CORE_CODE_SED,               (CpuHandlerImplied<CpuExecuteSED>)) \
+    /* SEI */ \
+    X(CORE_CODE_SEI,               (CpuHandlerImplied<CpuExecuteSEI>)) \
+    /* CMP */ \
+    X(CORE_CODE_CMP_IMMD,          (CpuHandlerRead<CpuExecuteCMP, CpuModeImmediately>)) \
+    X(CORE_CODE_CMP_ZEROPAGE,      (CpuHandlerRead<CpuExecuteCMP, CpuModeZeroPage>)) \
+    X(CORE_CODE_CMP_ZEROPAGEX_IDX, (CpuHandlerRead<CpuExecuteCMP, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_CMP_ABSOLUTE,      (CpuHandlerRead<CpuExecuteCMP, CpuModeAbsolute>)) \
+    X(CORE_CODE_CMP_ABSOLUTEIX,    (CpuHandlerRead<CpuExecuteCMP, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_CMP_ABSOLUTEIY,    (CpuHandlerRead<CpuExecuteCMP, CpuModeAbsoluteOffsetY>)) \
+    X(CORE_CODE_CMP_PREIDX,        (CpuHandlerRead<CpuExecuteCMP, CpuModePreIndirectX>)) \
+    X(CORE_CODE_CMP_POSTIDY,       (CpuHandlerRead<CpuExecuteCMP, CpuModePostIndirectY>)) \
+    /* CPX */ \
+    X(CORE_CODE_CPX_IMMD,          (CpuHandlerRead<CpuExecuteCPX, CpuModeImmediately>)) \
+    X(CORE_CODE_CPX_ZEROPAGE,      (CpuHandlerRead<CpuExecuteCPX, CpuModeZeroPage>)) \
+    X(CORE_CODE_CPX_ABSOLUTE,      (CpuHandlerRead<CpuExecuteCPX, CpuModeAbsolute>)) \
+    /* CPY */ \
+    X(CORE_CODE_CPY_IMMD,          (CpuHandlerRead<CpuExecuteCPY, CpuModeImmediately>)) \
+    X(CORE_CODE_CPY_ZEROPAGE,      (CpuHandlerRead<CpuExecuteCPY, CpuModeZeroPage>)) \
+    X(CORE_CODE_CPY_ABSOLUTE,      (CpuHandlerRead<CpuExecuteCPY, CpuModeAbsolute>)) \
+    /* LDA */ \
+    X(CORE_CODE_LDA_IMMD,          (CpuHandlerRead<CpuExecuteSetRegisterA, CpuModeImmediately>)) \
+    X(CORE_CODE_LDA_ZEROPAGE,      (CpuHandlerRead<CpuExecuteSetRegisterA, CpuModeZeroPage>)) \
+    X(CORE_CODE_LDA_ZEROPAGEIX,    (CpuHandlerRead<CpuExecuteSetRegisterA, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_LDA_ABSOLUTE,      (CpuHandlerRead<CpuExecuteSetRegisterA, CpuModeAbsolute>)) \
+    X(CORE_CODE_LDA_ABSOLUTEIX,    (CpuHandlerRead<CpuExecuteSetRegisterA, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_LDA_ABSOLUTEIY,    (CpuHandlerRead<CpuExecuteSetRegisterA, CpuModeAbsoluteOffsetY>)) \
+    X(CORE_CODE_LDA_PREIDX,        (CpuHandlerRead<CpuExecuteSetRegisterA, CpuModePreIndirectX>)) \
+    X(CORE_CODE_LDA_POSTIDY,       (CpuHandlerRead<CpuExecuteSetRegisterA, CpuModePostIndirectY>)) \
+    /* LDX */ \
+    X(CORE_CODE_LDX_IMMD,          (CpuHandlerRead<CpuExecuteSetRegisterX, CpuModeImmediately>)) \
+    X(CORE_CODE_LDX_ZEROPAGE,      (CpuHandlerRead<CpuExecuteSetRegisterX, CpuModeZeroPage>)) \
+    X(CORE_CODE_LDX_ZEROPAGEIY,    (CpuHandlerRead<CpuExecuteSetRegisterX, CpuModeZeroPageIndexY>)) \
+    X(CORE_CODE_LDX_ABSOLUTE,      (CpuHandlerRead<CpuExecuteSetRegisterX, CpuModeAbsolute>)) \
+    X(CORE_CODE_LDX_ABSOLUTEIY,    (CpuHandlerRead<CpuExecuteSetRegisterX, CpuModeAbsoluteOffsetY>)) \
+    /* LDY */ \
+    X(CORE_CODE_LDY_IMMD,          (CpuHandlerRead<CpuExecuteSetRegisterY, CpuModeImmediately>)) \
+    X(CORE_CODE_LDY_ZEROPAGE,      (CpuHandlerRead<CpuExecuteSetRegisterY, CpuModeZeroPage>)) \
+    X(CORE_CODE_LDY_ZEROPAGEIX,    (CpuHandlerRead<CpuExecuteSetRegisterY, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_LDY_ABSOLUTE,      (CpuHandlerRead<CpuExecuteSetRegisterY, CpuModeAbsolute>)) \
+    X(CORE_CODE_LDY_ABSOLUTEIX,    (CpuHandlerRead<CpuExecuteSetRegisterY, CpuModeAbsoluteOffsetX>)) \
+    /* STA */ \
+    X(CORE_CODE_STA_ZEROPAGE,      (CpuHandlerModify<CpuExecuteStoreRegisterA, CpuModeZeroPage>)) \
+    X(CORE_CODE_STA_ZEROPAGEIX,    (CpuHandlerModify<CpuExecuteStoreRegisterA, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_STA_ABSOLUTE,      (CpuHandlerModify<CpuExecuteStoreRegisterA, CpuModeAbsolute>)) \
+    X(CORE_CODE_STA_ABSOLUTEIX,    (CpuHandlerModify<CpuExecuteStoreRegisterA, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_STA_ABSOLUTEIY,    (CpuHandlerModify<CpuExecuteStoreRegisterA, CpuModeAbsoluteOffsetY>)) \
+    X(CORE_CODE_STA_PREIDX,        (CpuHandlerModify<CpuExecuteStoreRegisterA, CpuModePreIndirectX>)) \
+    X(CORE_CODE_STA_POSTIDY,       (CpuHandlerModify<CpuExecuteStoreRegisterA, CpuModePostIndirectY>)) \
+    /* STX */ \
+    X(CORE_CODE_STX_ZEROPAGE,      (CpuHandlerModify<CpuExecuteStoreRegisterX, CpuModeZeroPage>)) \
+    X(CORE_CODE_STX_ZEROPAGEIY,    (CpuHandlerModify<CpuExecuteStoreRegisterX, CpuModeZeroPageIndexY>)) \
+    X(CORE_CODE_STX_ABSOLUTE,      (CpuHandlerModify<CpuExecuteStoreRegisterX, CpuModeAbsolute>)) \
+    /* STY */ \
+    X(CORE_CODE_STY_ZEROPAGE,      (CpuHandlerModify<CpuExecuteStoreRegisterY, CpuModeZeroPage>)) \
+    X(CORE_CODE_STY_ZEROPAGEIX,    (CpuHandlerModify<CpuExecuteStoreRegisterY, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_STY_ABSOLUTE,      (CpuHandlerModify<CpuExecuteStoreRegisterY, CpuModeAbsolute>)) \
+    /* TAX */ \
+    X(CORE_CODE_TAX,               (CpuHandlerImplied<CpuExecuteTAX>)) \
+    /* TAY */ \
+    X(CORE_CODE_TAY,               (CpuHandlerImplied<CpuExecuteTAY>)) \
+    /* TSX */ \
+    X(CORE_CODE_TSX,               (CpuHandlerImplied<CpuExecuteTSX>)) \
+    /* TXA */ \
+    X(CORE_CODE_TXA,               (CpuHandlerImplied<CpuExecuteTXA>)) \
+    /* TXS */ \
+    X(CORE_CODE_TXS,               (CpuHandlerImplied<CpuExecuteTXS>)) \
+    /* TYA */ \
+    X(CORE_CODE_TYA,               (CpuHandlerImplied<CpuExecuteTYA>)) \
+    /* PHA */ \
+    X(CORE_CODE_PHA,               (CpuHandlerStack<CpuExecutePHA>)) \
+    /* PHP */ \
+    X(CORE_CODE_PHP,               (CpuHandlerStack<CpuExecutePHP>)) \
+    /* PLA */ \
+    X(CORE_CODE_PLA,               (CpuHandlerStack<CpuExecutePLA>)) \
+    /* PLP */ \
+    X(CORE_CODE_PLP,               (CpuHandlerStack<CpuExecutePLP>)) \
+    /* NOP */ \
+    X(CORE_CODE_NOP,               (CpuHandlerSkip<1>)) \
+    X(CORE_CODE_NOP_2,             (CpuHandlerSkip<1>)) \
+    X(CORE_CODE_NOP_3,             (CpuHandlerSkip<1>)) \
+    X(CORE_CODE_NOP_4,             (CpuHandlerSkip<1>)) \
+    X(CORE_CODE_NOP_5,             (CpuHandlerSkip<1>)) \
+    X(CORE_CODE_NOP_6,             (CpuHandlerSkip<1>)) \
+    X(CORE_CODE_NOP_7,             (CpuHandlerSkip<1>)) \
+    X(CORE_CODE_NOP_ZEROPAGE,      (CpuHandlerSkip<2>)) \
+    X(CORE_CODE_NOP_ZEROPAGE_2,    (CpuHandlerSkip<2>)) \
+    X(CORE_CODE_NOP_ZEROPAGE_3,    (CpuHandlerSkip<2>)) \
+    X(CORE_CODE_NOP_ZEROPAGEIX,    (CpuHandlerSkip<2>)) \
+    X(CORE_CODE_NOP_ZEROPAGEIX_2,  (CpuHandlerSkip<2>)) \
+    X(CORE_CODE_NOP_ZEROPAGEIX_3,  (CpuHandlerSkip<2>)) \
+    X(CORE_CODE_NOP_ZEROPAGEIX_4,  (CpuHandlerSkip<2>)) \
+    X(CORE_CODE_NOP_ZEROPAGEIX_5,  (CpuHandlerSkip<2>)) \
+    X(CORE_CODE_NOP_ZEROPAGEIX_6,  (CpuHandlerSkip<2>)) \
+    X(CORE_CODE_NOP_ABSOLUTE,      (CpuHandlerSkip<3>)) \
+    X(CORE_CODE_NOP_IMMD,          (CpuHandlerSkip<2>)) \
+    X(CORE_CODE_NOP_IMMD_2,        (CpuHandlerSkip<2>)) \
+    X(CORE_CODE_NOP_IMMD_3,        (CpuHandlerSkip<2>)) \
+    X(CORE_CODE_NOP_IMMD_4,        (CpuHandlerSkip<2>)) \
+    X(CORE_CODE_NOP_IMMD_5,        (CpuHandlerSkip<2>)) \
+    X(CORE_CODE_NOP_ABSOLUTEIX,    (CpuHandlerModify<CpuExecuteNOP, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_NOP_ABSOLUTEIX_2,  (CpuHandlerModify<CpuExecuteNOP, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_NOP_ABSOLUTEIX_3,  (CpuHandlerModify<CpuExecuteNOP, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_NOP_ABSOLUTEIX_4,  (CpuHandlerModify<CpuExecuteNOP, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_NOP_ABSOLUTEIX_5,  (CpuHandlerModify<CpuExecuteNOP, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_NOP_ABSOLUTEIX_6,  (CpuHandlerModify<CpuExecuteNOP, CpuModeAbsoluteOffsetX>)) \
+    /* LAX */ \
+    X(CORE_CODE_LAX_ZEROPAGE,      (CpuHandlerRead<CpuExecuteLAX, CpuModeZeroPage>)) \
+    X(CORE_CODE_LAX_ZEROPAGEIY,    (CpuHandlerRead<CpuExecuteLAX, CpuModeZeroPageIndexY>)) \
+    X(CORE_CODE_LAX_ABSOLUTE,      (CpuHandlerRead<CpuExecuteLAX, CpuModeAbsolute>)) \
+    X(CORE_CODE_LAX_ABSOLUTEIY,    (CpuHandlerRead<CpuExecuteLAX, CpuModeAbsoluteOffsetY>)) \
+    X(CORE_CODE_LAX_PREIDX,        (CpuHandlerRead<CpuExecuteLAX, CpuModePreIndirectX>)) \
+    X(CORE_CODE_LAX_POSTIDY,       (CpuHandlerRead<CpuExecuteLAX, CpuModePostIndirectY>)) \
+    /* SAX */ \
+    X(CORE_CODE_SAX_ZEROPAGE,      (CpuHandlerModify<CpuExecuteSAX, CpuModeZeroPage>)) \
+    X(CORE_CODE_SAX_ZEROPAGEIY,    (CpuHandlerModify<CpuExecuteSAX, CpuModeZeroPageIndexY>)) \
+    X(CORE_CODE_SAX_PREIDX,        (CpuHandlerModify<CpuExecuteSAX, CpuModePreIndirectX>)) \
+    X(CORE_CODE_SAX_ABSOLUTE,      (CpuHandlerModify<CpuExecuteSAX, CpuModeAbsolute>)) \
+    /* SBC v2 */ \
+    X(CORE_CODE_SBC_IMMD_2,        (CpuHandlerRead<CpuExecuteSBC, CpuModeImmediately>)) \
+    /* DCP */ \
+    X(CORE_CODE_DCP_ZEROPAGE,      (CpuHandlerModify<CpuExecuteDCP, CpuModeZeroPage>)) \
+    X(CORE_CODE_DCP_ZEROPAGEIX,    (CpuHandlerModify<CpuExecuteDCP, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_DCP_ABSOLUTE,      (CpuHandlerModify<CpuExecuteDCP, CpuModeAbsolute>)) \
+    X(CORE_CODE_DCP_ABSOLUTEIX,    (CpuHandlerModify<CpuExecuteDCP, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_DCP_ABSOLUTEIY,    (CpuHandlerModify<CpuExecuteDCP, CpuModeAbsoluteOffsetY>)) \
+    X(CORE_CODE_DCP_PREIDX,        (CpuHandlerModify<CpuExecuteDCP, CpuModePreIndirectX>)) \
+    X(CORE_CODE_DCP_POSTIDY,       (CpuHandlerModify<CpuExecuteDCP, CpuModePostIndirectY>)) \
+    /* ISB */ \
+    X(CORE_CODE_ISB_ZEROPAGE,      (CpuHandlerModify<CpuExecuteISB, CpuModeZeroPage>)) \
+    X(CORE_CODE_ISB_ZEROPAGEIX,    (CpuHandlerModify<CpuExecuteISB, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_ISB_ABSOLUTE,      (CpuHandlerModify<CpuExecuteISB, CpuModeAbsolute>)) \
+    X(CORE_CODE_ISB_ABSOLUTEIX,    (CpuHandlerModify<CpuExecuteISB, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_ISB_ABSOLUTEIY,    (CpuHandlerModify<CpuExecuteISB, CpuModeAbsoluteOffsetY>)) \
+    X(CORE_CODE_ISB_PREIDX,        (CpuHandlerModify<CpuExecuteISB, CpuModePreIndirectX>)) \
+    X(CORE_CODE_ISB_POSTIDY,       (CpuHandlerModify<CpuExecuteISB, CpuModePostIndirectY>)) \
+    /* SLO */ \
+    X(CORE_CODE_SLO_ZEROPAGE,      (CpuHandlerModify<CpuExecuteSLO, CpuModeZeroPage>)) \
+    X(CORE_CODE_SLO_ZEROPAGEIX,    (CpuHandlerModify<CpuExecuteSLO, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_SLO_ABSOLUTE,      (CpuHandlerModify<CpuExecuteSLO, CpuModeAbsolute>)) \
+    X(CORE_CODE_SLO_ABSOLUTEIX,    (CpuHandlerModify<CpuExecuteSLO, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_SLO_ABSOLUTEIY,    (CpuHandlerModify<CpuExecuteSLO, CpuModeAbsoluteOffsetY>)) \
+    X(CORE_CODE_SLO_PREIDX,        (CpuHandlerModify<CpuExecuteSLO, CpuModePreIndirectX>)) \
+    X(CORE_CODE_SLO_POSTIDY,       (CpuHandlerModify<CpuExecuteSLO, CpuModePostIndirectY>)) \
+    X(CORE_CODE_RLA_ZEROPAGE,      (CpuHandlerModify<CpuExecuteRLA, CpuModeZeroPage>)) \
+    X(CORE_CODE_RLA_ZEROPAGEIX,    (CpuHandlerModify<CpuExecuteRLA, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_RLA_ABSOLUTE,      (CpuHandlerModify<CpuExecuteRLA, CpuModeAbsolute>)) \
+    X(CORE_CODE_RLA_ABSOLUTEIX,    (CpuHandlerModify<CpuExecuteRLA, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_RLA_ABSOLUTEIY,    (CpuHandlerModify<CpuExecuteRLA, CpuModeAbsoluteOffsetY>)) \
+    X(CORE_CODE_RLA_PREIDX,        (CpuHandlerModify<CpuExecuteRLA, CpuModePreIndirectX>)) \
+    X(CORE_CODE_RLA_POSTIDY,       (CpuHandlerModify<CpuExecuteRLA, CpuModePostIndirectY>)) \
+    /* SRE */ \
+    X(CORE_CODE_SRE_ZEROPAGE,      (CpuHandlerModify<CpuExecuteSRE, CpuModeZeroPage>)) \
+    X(CORE_CODE_SRE_ZEROPAGEIX,    (CpuHandlerModify<CpuExecuteSRE, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_SRE_ABSOLUTE,      (CpuHandlerModify<CpuExecuteSRE, CpuModeAbsolute>)) \
+    X(CORE_CODE_SRE_ABSOLUTEIX,    (CpuHandlerModify<CpuExecuteSRE, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_SRE_ABSOLUTEIY,    (CpuHandlerModify<CpuExecuteSRE, CpuModeAbsoluteOffsetY>)) \
+    X(CORE_CODE_SRE_PREIDX,        (CpuHandlerModify<CpuExecuteSRE, CpuModePreIndirectX>)) \
+    X(CORE_CODE_SRE_POSTIDY,       (CpuHandlerModify<CpuExecuteSRE, CpuModePostIndirectY>)) \
+    /* RRA */ \
+    X(CORE_CODE_RRA_ZEROPAGE,      (CpuHandlerModify<CpuExecuteRRA, CpuModeZeroPage>)) \
+    X(CORE_CODE_RRA_ZEROPAGEIX,    (CpuHandlerModify<CpuExecuteRRA, CpuModeZeroPageIndexX>)) \
+    X(CORE_CODE_RRA_ABSOLUTE,      (CpuHandlerModify<CpuExecuteRRA, CpuModeAbsolute>)) \
+    X(CORE_CODE_RRA_ABSOLUTEIX,    (CpuHandlerModify<CpuExecuteRRA, CpuModeAbsoluteOffsetX>)) \
+    X(CORE_CODE_RRA_ABSOLUTEIY,    (CpuHandlerModify<CpuExecuteRRA, CpuModeAbsoluteOffsetY>)) \
+    X(CORE_CODE_RRA_PREIDX,        (CpuHandlerModify<CpuExecuteRRA, CpuModePreIndirectX>)) \
+    X(CORE_CODE_RRA_POSTIDY,       (CpuHandlerModify<CpuExecuteRRA, CpuModePostIndirectY>))
@@ -4,10 +4,14 @@
 #include "iNesInstance.hpp"
 
 struct INesInstance;
+struct CPUJit;
+struct CPUTrace;
+struct CPUProfile;
+struct CPUStats;
 
 #define Core_PrintANZCV(tag) \
     printf("[%s:%d] ANZCV = [A: 0x%02x, N: %d, Z: %d, C: %d, V: %d]\n", tag, (int)__LINE__, \
-            (int)s_cpu->registerA, s_cpu->flag.N, s_cpu->flag.Z, s_cpu->flag.C, s_cpu->flag.V)
+            (int)s_cpu->registerA, CpuFlagN(s_cpu), CpuFlagZ(s_cpu), s_cpu->flagC, s_cpu->flagV)
 
 #define FRAMES_PER_SECOND_NTSC          60
 #define SCANLINE_PER_FRAME_NTSC         262
@@ -256,12 +260,74 @@ struct INesInstance;
 
 typedef uint16_t ADDR;
 
+enum CPUAddressingMode {
+    CPUAddressingImplied = 0,       // 隐含寻址和栈操作
+    CPUAddressingAccumulator,
+    CPUAddressingImmediate,
+    CPUAddressingZeroPage,
+    CPUAddressingZeroPageX,
+    CPUAddressingZeroPageY,
+    CPUAddressingAbsolute,
+    CPUAddressingAbsoluteX,
+    CPUAddressingAbsoluteY,
+    CPUAddressingIndirect,          // JMP ($nnnn)
+    CPUAddressingIndirectX,         // ($nn,X)
+    CPUAddressingIndirectY,         // ($nn),Y
+    CPUAddressingRelative,
+    CPUAddressingModeCount
+};
+
 struct CPUInstruction {
     uint8_t code;
     const char* name;
     uint8_t size;
     uint8_t cycle;
     uint8_t crossPageType; // 0: no cross; 1: add one when cross; 2: same page add one and other add two
+    uint8_t mode;          // CPUAddressingMode
+};
+
+#define CPU_BLOCK_CACHE_SIZE            (1024)
+#define CPU_BLOCK_MAX_INSTRUCTIONS      (16)
+#define CPU_BLOCK_KEY_RAM               (0x40000000)
+#define CPU_BLOCK_KEY_WINDOW_SHIFT      (24)        // PRG ROM 中的代码在 key 的高位记录所在的 8KB 窗口
+
+// 预先解码的指令
+struct CPUDecodedInstruction {
+    uint16_t pc;
+    uint16_t operand;
+    uint8_t opcode;
+};
+
+// 从某个地址开始到下一条跳转指令为止的一段指令
+struct CPUDecodedBlock {
+    int32_t key;        // 窗口 << CPU_BLOCK_KEY_WINDOW_SHIFT | PRG ROM 偏移，内部 RAM 中的代码为 CPU_BLOCK_KEY_RAM | 地址，-1 为空
+    uint32_t RAMGeneration;
+    uint8_t count;
+    CPUDecodedInstruction instructions[CPU_BLOCK_MAX_INSTRUCTIONS];
+};
+
+struct CPUBlockCache {
+    uint32_t PRGGeneration;                 // 与 mapper->PRGGeneration 不同时重新计算 PRGWindow
+    int32_t PRGWindow[4];                   // $8000/$A000/$C000/$E000 映射到的 PRG ROM 偏移
+    uint32_t RAMGeneration;                 // 写入 RAM 中的代码时递增
+    uint8_t RAMCodePage[0x20];              // 内部 RAM 每 256 字节是否包含已解码的代码
+    CPUDecodedBlock* block;                 // 正在执行的 block
+    uint8_t index;                          // 下一条指令在 block 中的位置
+    CPUDecodedInstruction scratch;          // 不可缓存的指令
+    CPUDecodedBlock* blocks;                // CPU_BLOCK_CACHE_SIZE 个，见 CpuSetBlockCache，为 NULL 时每条指令都解码到 scratch
+};
+
+#define CPU_IDLE_MAX_INSTRUCTIONS       (8)
+
+// 只读取内部 RAM 或 PPUSTATUS、不写入任何地址的短循环，例如 LDA $2002 / BPL 或者等待 NMI 修改 RAM 中的标志。
+// 执行一次之后寄存器不再变化，在 PPUSTATUS 变化或出现 NMI/IRQ 之前每次循环的结果都相同。
+struct CPUIdleLoop {
+    uint8_t count;
+    uint8_t status;                                             // 循环中读取到的 PPUSTATUS
+    CPUDecodedInstruction instructions[CPU_IDLE_MAX_INSTRUCTIONS];
+    uint8_t cycles[CPU_IDLE_MAX_INSTRUCTIONS];                  // 基础时钟数，指令在最后一个时钟读取内存
+    uint8_t extraCycles[CPU_IDLE_MAX_INSTRUCTIONS];             // 跳回循环开始的分支的额外时钟
+    bool readStatus[CPU_IDLE_MAX_INSTRUCTIONS];
 };
 
 struct CPUClock {
@@ -291,10 +357,14 @@ struct CPU2A03 {
     uint8_t registerY;
     uint8_t stackPointer;
     union {
-        CPU2A03Flag flag;
+        CPU2A03Flag flag;               // 只有 I/D/B/U 有效，完整的 P 用 CpuGetFlags 读取
         uint8_t p;
     };
     uint16_t pc;
+    // N/Z 由最近一次运算结果延迟计算：Z 为低 8 位是否为 0，N 为 bit 7 或 bit 8（BIT 指令）
+    uint16_t flagNZ;
+    uint8_t flagC;
+    uint8_t flagV;
 
     // helper variables
     bool nmi;
@@ -313,9 +383,15 @@ struct CPU2A03 {
     int crossPageCycle;
     uint8_t opcodeCycle;
     ADDR lastAddressing;
-    CPUInstruction* info;
+    const CPUInstruction* info;
     bool cacheFlag;
     uint8_t opcode;
+    const CPUDecodedInstruction* decoded;
+    CPUBlockCache blockCache;
+    CPUJit* jit;
+    CPUTrace* trace;                    // 只在定义 NES_CPU_TRACE 时使用，见 NesCPUTrace.hpp
+    CPUProfile* profile;                // CpuProfileStart 之后不为 NULL，见 NesCPUProfile.hpp
+    CPUStats* stats;                    // CpuStatsStart 之后不为 NULL，见 NesCPUStats.hpp
 };
 struct CPUInfo {
     uint8_t lastCycle;
@@ -328,12 +404,71 @@ struct CPUInfo {
 #pragma pack()
 #endif
 
+#define CPU_FLAG_C                      (0x01)
+#define CPU_FLAG_Z                      (0x02)
+#define CPU_FLAG_I                      (0x04)
+#define CPU_FLAG_D                      (0x08)
+#define CPU_FLAG_B                      (0x10)
+#define CPU_FLAG_U                      (0x20)
+#define CPU_FLAG_V                      (0x40)
+#define CPU_FLAG_N                      (0x80)
+
+static inline uint8_t CpuFlagZ(const CPU2A03* cpu) {
+    return (cpu->flagNZ & 0xff) == 0 ? 1 : 0;
+}
+
+static inline uint8_t CpuFlagN(const CPU2A03* cpu) {
+    return (cpu->flagNZ & 0x180) != 0 ? 1 : 0;
+}
+
+// 合成完整的 P，压栈、调试时使用
+static inline uint8_t CpuGetFlags(const CPU2A03* cpu) {
+    uint8_t p = cpu->p & (CPU_FLAG_I | CPU_FLAG_D | CPU_FLAG_B | CPU_FLAG_U);
+    p |= cpu->flagC ? CPU_FLAG_C : 0;
+    p |= CpuFlagZ(cpu) ? CPU_FLAG_Z : 0;
+    p |= cpu->flagV ? CPU_FLAG_V : 0;
+    p |= CpuFlagN(cpu) ? CPU_FLAG_N : 0;
+    return p;
+}
+
+static inline void CpuSetFlags(CPU2A03* cpu, uint8_t p) {
+    cpu->p = p & (CPU_FLAG_I | CPU_FLAG_D | CPU_FLAG_B | CPU_FLAG_U);
+    cpu->flagC = (p & CPU_FLAG_C) ? 1 : 0;
+    cpu->flagV = (p & CPU_FLAG_V) ? 1 : 0;
+    cpu->flagNZ = ((p & CPU_FLAG_Z) ? 0 : 1) | ((p & CPU_FLAG_N) ? 0x100 : 0);
+}
+
+// 指令处理函数，addr 为指令所在地址，operand 为预先取出的操作数
+typedef void (*CpuHandler)(CPU2A03* cpu, INesInstance* instance, ADDR addr, uint16_t operand);
+
+const CPUInstruction* GetCPUInstructionBook(int* pSize);
+CpuHandler CpuGetHandler(uint8_t opcode);
+
 void CpuInit(CPU2A03* cpu);
 void CpuStealCycles(CPU2A03* cpu, int stealCount);
 void CpuReset(CPU2A03* cpu, INesInstance* instance);
 void CpuNMI(CPU2A03* cpu, INesInstance* instance);
 bool CpuTick(CPU2A03* cpu, INesInstance* instance);
 void CpuStep(CPU2A03* cpu, INesInstance* instance);
+const CPUDecodedInstruction* CpuDecodeInstruction(CPU2A03* cpu, INesInstance* instance, ADDR pc);
+void CpuInvalidateRAMCode(CPU2A03* cpu);
+// 指令级和 JIT 模式下开启 block 缓存，逐时钟模式下释放，缓存约 110KB
+void CpuSetBlockCache(CPU2A03* cpu, bool enable);
+bool CpuIsBlockEnd(uint8_t opcode);
+int32_t CpuCodeKey(CPU2A03* cpu, INesInstance* instance, ADDR pc);
+
+// 指令级执行接口：CpuBeginInstruction 在指令边界决定下一个操作（指令、NMI 或 IRQ）并返回其基础时钟数，
+// 调用方推进相应的 PPU/APU 时钟后再调用 CpuEndInstruction 完成执行，时序与逐时钟的 CpuTick 一致。
+bool CpuAtInstructionBoundary(const CPU2A03* cpu);
+uint8_t CpuBeginInstruction(CPU2A03* cpu, INesInstance* instance);
+void CpuEndInstruction(CPU2A03* cpu, INesInstance* instance);
+
+// 刚执行完向后跳转时检查从 pc 开始是否为空转循环（按当前寄存器执行一次后回到 pc 且寄存器不变）。
+// 跳过其中的指令时调用 CpuSkipIdleInstruction；指令读取的 PPUSTATUS 变化时，
+// 在读取的时钟调用 CpuResumeIdleInstruction 和 CpuEndInstruction 真正执行这条指令。
+bool CpuDetectIdleLoop(CPU2A03* cpu, INesInstance* instance, CPUIdleLoop* loop);
+void CpuSkipIdleInstruction(CPU2A03* cpu, const CPUIdleLoop* loop, uint8_t index);
+void CpuResumeIdleInstruction(CPU2A03* cpu, INesInstance* instance, const CPUIdleLoop* loop, uint8_t index);
 
 ADDR CpuExecuteReset(CPU2A03* cpu, INesInstance* instance);
 ADDR CpuExecute(CPU2A03* cpu, INesInstance* instance, ADDR addr);
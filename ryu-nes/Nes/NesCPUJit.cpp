@@ -0,0 +1,1132 @@
+#include "NesCPUJit.hpp"
+#include "NesCPUAOT.hpp"
+#include "NesCPUTrace.hpp"
+#include "NesCPUProfile.hpp"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#if NES_CPU_JIT
+#include <sys/mman.h>
+#if defined(__APPLE__)
+#include <pthread.h>
+#endif
+#endif
+
+// 只访问内部 RAM（或不访问内存）且时钟数固定的指令，PPU/APU 无法观察到它与 PPU/APU 的先后顺序。
+// CLI/SEI/PLP 会改变 I 标志，而 APU/mapper 在产生 IRQ 时会检查 I 标志，所以不包括在内。
+bool CpuJitIsPure(uint8_t opcode, uint16_t operand) {
+    const CPUInstruction* info = GetCPUInstructionBook(NULL) + opcode;
+    if (info->size == 0 || info->crossPageType != 0 || CpuIsBlockEnd(opcode)) {
+        return false;
+    }
+    if (opcode == CORE_CODE_CLI || opcode == CORE_CODE_SEI || opcode == CORE_CODE_PLP) {
+        return false;
+    }
+
+    // 操作码 aaabbbcc 中 bbb 为寻址模式
+    uint8_t group = opcode & 3;
+    uint8_t mode = (opcode >> 2) & 7;
+    switch (info->size) {
+        case 1:
+            // 隐含寻址、累加器或栈操作
+            return true;
+        case 2:
+            // (zp,X) 和 (zp),Y 的目标地址在执行时才能确定，其它为立即数、零页或零页变址
+            if (group & 1) {
+                return mode != 0 && mode != 4;
+            }
+            return true;
+        case 3:
+            if (mode == 3) {
+                return operand < 0x2000;
+            }
+            return operand + 0xff < 0x2000;
+        default:
+            return false;
+    }
+}
+
+static void CpuJitFlush(CPUJit* jit) {
+    for (int i = 0; i < CPU_JIT_CACHE_SIZE; ++i) {
+        jit->blocks[i].key = -1;
+    }
+    jit->codeUsed = 0;
+}
+
+#if NES_CPU_JIT
+
+// 生成的代码不调用任何函数，只使用调用者保存的寄存器，6502 的寄存器和标志留在 CPU2A03 中：
+//   rdi = cpu，rsi = instance
+//   r8d = budget 减去下一条指令开始的时钟，不大于 0 时在这条指令之前退出
+//   r9d = 上一条指令跨页或分支的额外时钟，下一条指令开始的时钟已经包括它，退出时写回 cpu->extraCycle
+//   r10d = budget
+//   eax/ecx/edx 为临时寄存器，r11 为访问内存的主机地址
+enum CPUJitRegister {
+    CPUJitRAX = 0,
+    CPUJitRCX = 1,
+    CPUJitRDX = 2,
+    CPUJitNoIndex = 4,          // SIB 中没有变址寄存器
+    CPUJitRSI = 6,
+    CPUJitRDI = 7,
+    CPUJitR8 = 8,
+    CPUJitR9 = 9,
+    CPUJitR10 = 10,
+    CPUJitR11 = 11,
+};
+
+// x86 的条件码，与 0x0f 0x80 + cc（jcc）和 0x0f 0x90 + cc（setcc）一起使用，cc ^ 1 为相反的条件
+enum CPUJitCondition {
+    CPUJitConditionO = 0x0,
+    CPUJitConditionB = 0x2,
+    CPUJitConditionAE = 0x3,
+    CPUJitConditionE = 0x4,
+    CPUJitConditionNE = 0x5,
+    CPUJitConditionLE = 0xe,
+};
+
+#define CPU_JIT_OP_16                   (0x100)     // 0x66 前缀，16 位操作数
+#define CPU_JIT_OP_64                   (0x200)     // REX.W，64 位操作数
+#define CPU_JIT_OP_0F                   (0x400)     // 0x0f 开始的两字节操作码
+
+// 每条指令生成的机器码不超过 192 字节，退出代码不超过 16 字节
+#define CPU_JIT_MAX_BLOCK_BYTES         (64 + CPU_JIT_MAX_INSTRUCTIONS * (192 + 16))
+#define CPU_JIT_MAX_FIXUPS              (CPU_JIT_MAX_INSTRUCTIONS * 6)
+
+// 按指令表中的助记符分类，同一类指令的寻址模式由 CPUInstruction::mode 区分
+enum CPUJitOperation {
+    CPUJitOperationNone = 0,    // 不编译，代码段在这条指令之前结束
+    CPUJitOperationLDA,
+    CPUJitOperationLDX,
+    CPUJitOperationLDY,
+    CPUJitOperationLAX,
+    CPUJitOperationSTA,
+    CPUJitOperationSTX,
+    CPUJitOperationSTY,
+    CPUJitOperationSAX,
+    CPUJitOperationORA,
+    CPUJitOperationAND,
+    CPUJitOperationEOR,
+    CPUJitOperationADC,
+    CPUJitOperationSBC,
+    CPUJitOperationCMP,
+    CPUJitOperationCPX,
+    CPUJitOperationCPY,
+    CPUJitOperationBIT,
+    CPUJitOperationASL,
+    CPUJitOperationLSR,
+    CPUJitOperationROL,
+    CPUJitOperationROR,
+    CPUJitOperationINC,
+    CPUJitOperationDEC,
+    CPUJitOperationINX,
+    CPUJitOperationINY,
+    CPUJitOperationDEX,
+    CPUJitOperationDEY,
+    CPUJitOperationTAX,
+    CPUJitOperationTAY,
+    CPUJitOperationTXA,
+    CPUJitOperationTYA,
+    CPUJitOperationTSX,
+    CPUJitOperationTXS,
+    CPUJitOperationCLC,
+    CPUJitOperationSEC,
+    CPUJitOperationCLV,
+    CPUJitOperationCLD,
+    CPUJitOperationSED,
+    CPUJitOperationPHA,
+    CPUJitOperationPLA,
+    CPUJitOperationNOP,
+    CPUJitOperationBranch,
+    CPUJitOperationJMP,
+};
+
+// 指令访问内存的方式
+enum CPUJitAccess {
+    CPUJitAccessNone = 0,
+    CPUJitAccessRead,
+    CPUJitAccessWrite,
+    CPUJitAccessModify,
+};
+
+struct CPUJitMnemonic {
+    const char* name;
+    uint8_t operation;
+    uint8_t access;
+};
+
+// CLI/SEI/PLP 会改变 I 标志，PHP/JSR/RTS/RTI/BRK 和非官方的读改写组合指令较少执行，都由解释器执行
+static const CPUJitMnemonic g_mnemonics[] = {
+    { "lda", CPUJitOperationLDA, CPUJitAccessRead },
+    { "ldx", CPUJitOperationLDX, CPUJitAccessRead },
+    { "ldy", CPUJitOperationLDY, CPUJitAccessRead },
+    { "lax", CPUJitOperationLAX, CPUJitAccessRead },
+    { "sta", CPUJitOperationSTA, CPUJitAccessWrite },
+    { "stx", CPUJitOperationSTX, CPUJitAccessWrite },
+    { "sty", CPUJitOperationSTY, CPUJitAccessWrite },
+    { "sax", CPUJitOperationSAX, CPUJitAccessWrite },
+    { "ora", CPUJitOperationORA, CPUJitAccessRead },
+    { "and", CPUJitOperationAND, CPUJitAccessRead },
+    { "eor", CPUJitOperationEOR, CPUJitAccessRead },
+    { "adc", CPUJitOperationADC, CPUJitAccessRead },
+    { "sbc", CPUJitOperationSBC, CPUJitAccessRead },
+    { "cmp", CPUJitOperationCMP, CPUJitAccessRead },
+    { "cpx", CPUJitOperationCPX, CPUJitAccessRead },
+    { "cpy", CPUJitOperationCPY, CPUJitAccessRead },
+    { "bit", CPUJitOperationBIT, CPUJitAccessRead },
+    { "asl", CPUJitOperationASL, CPUJitAccessModify },
+    { "lsr", CPUJitOperationLSR, CPUJitAccessModify },
+    { "rol", CPUJitOperationROL, CPUJitAccessModify },
+    { "ror", CPUJitOperationROR, CPUJitAccessModify },
+    { "inc", CPUJitOperationINC, CPUJitAccessModify },
+    { "dec", CPUJitOperationDEC, CPUJitAccessModify },
+    { "inx", CPUJitOperationINX, CPUJitAccessNone },
+    { "iny", CPUJitOperationINY, CPUJitAccessNone },
+    { "dex", CPUJitOperationDEX, CPUJitAccessNone },
+    { "dey", CPUJitOperationDEY, CPUJitAccessNone },
+    { "tax", CPUJitOperationTAX, CPUJitAccessNone },
+    { "tay", CPUJitOperationTAY, CPUJitAccessNone },
+    { "txa", CPUJitOperationTXA, CPUJitAccessNone },
+    { "tya", CPUJitOperationTYA, CPUJitAccessNone },
+    { "tsx", CPUJitOperationTSX, CPUJitAccessNone },
+    { "txs", CPUJitOperationTXS, CPUJitAccessNone },
+    { "clc", CPUJitOperationCLC, CPUJitAccessNone },
+    { "sec", CPUJitOperationSEC, CPUJitAccessNone },
+    { "clv", CPUJitOperationCLV, CPUJitAccessNone },
+    { "cld", CPUJitOperationCLD, CPUJitAccessNone },
+    { "sed", CPUJitOperationSED, CPUJitAccessNone },
+    { "pha", CPUJitOperationPHA, CPUJitAccessNone },
+    { "pla", CPUJitOperationPLA, CPUJitAccessNone },
+    { "nop", CPUJitOperationNOP, CPUJitAccessNone },       // 非官方的 NOP 不读取操作数
+    { "bcc", CPUJitOperationBranch, CPUJitAccessNone },
+    { "bcs", CPUJitOperationBranch, CPUJitAccessNone },
+    { "beq", CPUJitOperationBranch, CPUJitAccessNone },
+    { "bmi", CPUJitOperationBranch, CPUJitAccessNone },
+    { "bne", CPUJitOperationBranch, CPUJitAccessNone },
+    { "bpl", CPUJitOperationBranch, CPUJitAccessNone },
+    { "bvc", CPUJitOperationBranch, CPUJitAccessNone },
+    { "bvs", CPUJitOperationBranch, CPUJitAccessNone },
+    { "jmp", CPUJitOperationJMP, CPUJitAccessNone },
+};
+
+static const CPUJitMnemonic* CpuJitGetMnemonic(const CPUInstruction* info) {
+    if (info->size == 0 || info->mode == CPUAddressingIndirect) {
+        return NULL;
+    }
+    for (size_t i = 0; i < sizeof(g_mnemonics) / sizeof(g_mnemonics[0]); ++i) {
+        if (strncmp(info->name, g_mnemonics[i].name, 3) == 0 && (info->name[3] == '\0' || info->name[3] == '_')) {
+            return &g_mnemonics[i];
+        }
+    }
+    return NULL;
+}
+
+// 内存操作数 [base + index << scale + disp]
+struct CPUJitMemory {
+    uint8_t base;
+    uint8_t index;
+    uint8_t scale;
+    int32_t disp;
+};
+
+static CPUJitMemory CpuJitField(size_t offset) {
+    return { CPUJitRDI, CPUJitNoIndex, 0, (int32_t)offset };
+}
+
+static CPUJitMemory CpuJitRAM(uint32_t addr) {
+    return { CPUJitRSI, CPUJitNoIndex, 0, (int32_t)(offsetof(INesInstance, mem) + addr) };
+}
+
+// 跳转目标在整段生成之后才能确定
+enum CPUJitFixupKind {
+    CPUJitFixupLabel = 0,       // 代码段中的第 index 条指令
+    CPUJitFixupExit,            // 第 index 条指令之前退出
+};
+
+struct CPUJitFixup {
+    uint32_t position;          // rel32 的位置
+    uint8_t kind;
+    uint8_t index;
+};
+
+struct CPUJitAssembler {
+    CPUJit* jit;
+    const CPUDecodedInstruction* instructions;
+    uint8_t count;
+    uint8_t index;                                      // 正在生成的指令
+    bool penaltyZero;                                   // r9d 已知为 0
+    size_t epilogue;
+    size_t labels[CPU_JIT_MAX_INSTRUCTIONS];
+    bool targets[CPU_JIT_MAX_INSTRUCTIONS];             // 代码段中分支或 JMP 的目标
+    bool exits[CPU_JIT_MAX_INSTRUCTIONS];               // 需要生成退出代码
+    CPUJitFixup fixups[CPU_JIT_MAX_FIXUPS];
+    uint16_t fixupCount;
+};
+
+static void CpuJitEmitByte(CPUJit* jit, uint8_t byte) {
+    jit->code[jit->codeUsed++] = byte;
+}
+
+static void CpuJitEmit16(CPUJit* jit, uint16_t value) {
+    memcpy(jit->code + jit->codeUsed, &value, 2);
+    jit->codeUsed += 2;
+}
+
+static void CpuJitEmit32(CPUJit* jit, uint32_t value) {
+    memcpy(jit->code + jit->codeUsed, &value, 4);
+    jit->codeUsed += 4;
+}
+
+// 前缀、REX 和操作码，op 的低 8 位为操作码
+static void CpuJitEmitOpcode(CPUJit* jit, uint32_t op, uint8_t reg, uint8_t index, uint8_t base) {
+    if (op & CPU_JIT_OP_16) {
+        CpuJitEmitByte(jit, 0x66);
+    }
+    uint8_t rex = ((op & CPU_JIT_OP_64) ? 8 : 0) | ((reg >> 3) << 2) | ((index >> 3) << 1) | (base >> 3);
+    if (rex) {
+        CpuJitEmitByte(jit, 0x40 | rex);
+    }
+    if (op & CPU_JIT_OP_0F) {
+        CpuJitEmitByte(jit, 0x0f);
+    }
+    CpuJitEmitByte(jit, (uint8_t)op);
+}
+
+// op reg, [memory]，reg 也可以是 ModRM 中的扩展操作码
+static void CpuJitEmitMemory(CPUJit* jit, uint32_t op, uint8_t reg, CPUJitMemory memory) {
+    CpuJitEmitOpcode(jit, op, reg, memory.index, memory.base);
+    if (memory.index == CPUJitNoIndex && (memory.base & 7) != 4) {
+        CpuJitEmitByte(jit, 0x80 | ((reg & 7) << 3) | (memory.base & 7));
+    } else {
+        CpuJitEmitByte(jit, 0x84 | ((reg & 7) << 3));
+        CpuJitEmitByte(jit, (memory.scale << 6) | ((memory.index & 7) << 3) | (memory.base & 7));
+    }
+    CpuJitEmit32(jit, (uint32_t)memory.disp);
+}
+
+// op rm, reg
+static void CpuJitEmitRegister(CPUJit* jit, uint32_t op, uint8_t reg, uint8_t rm) {
+    CpuJitEmitOpcode(jit, op, reg, 0, rm);
+    CpuJitEmitByte(jit, 0xc0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+// add/or/and/sub/xor/cmp reg32, imm，ext 为 0x81 的扩展操作码
+static void CpuJitEmitArithmeticImm(CPUJit* jit, uint8_t ext, uint8_t reg, int32_t imm) {
+    if (imm >= -128 && imm <= 127) {
+        CpuJitEmitRegister(jit, 0x83, ext, reg);
+        CpuJitEmitByte(jit, (uint8_t)imm);
+    } else {
+        CpuJitEmitRegister(jit, 0x81, ext, reg);
+        CpuJitEmit32(jit, (uint32_t)imm);
+    }
+}
+
+// shl（ext 为 4）或 shr（ext 为 5）reg32, imm8
+static void CpuJitEmitShift(CPUJit* jit, uint8_t ext, uint8_t reg, uint8_t count) {
+    CpuJitEmitRegister(jit, 0xc1, ext, reg);
+    CpuJitEmitByte(jit, count);
+}
+
+// movzx reg32, byte [memory]
+static void CpuJitEmitLoad(CPUJit* jit, uint8_t reg, CPUJitMemory memory) {
+    CpuJitEmitMemory(jit, CPU_JIT_OP_0F | 0xb6, reg, memory);
+}
+
+// mov byte [memory], reg8
+static void CpuJitEmitStore(CPUJit* jit, uint8_t reg, CPUJitMemory memory) {
+    CpuJitEmitMemory(jit, 0x88, reg, memory);
+}
+
+// mov byte [memory], imm8
+static void CpuJitEmitStoreImm(CPUJit* jit, CPUJitMemory memory, uint8_t imm) {
+    CpuJitEmitMemory(jit, 0xc6, 0, memory);
+    CpuJitEmitByte(jit, imm);
+}
+
+// reg 为零扩展的运算结果，见 SetFlagZN
+static void CpuJitEmitFlagZN(CPUJit* jit, uint8_t reg) {
+    CpuJitEmitMemory(jit, CPU_JIT_OP_16 | 0x89, reg, CpuJitField(offsetof(CPU2A03, flagNZ)));
+}
+
+// mov word [rdi + pc], imm16
+static void CpuJitEmitSetPC(CPUJit* jit, ADDR pc) {
+    CpuJitEmitMemory(jit, CPU_JIT_OP_16 | 0xc7, 0, CpuJitField(offsetof(CPU2A03, pc)));
+    CpuJitEmit16(jit, pc);
+}
+
+// jmp rel32 到已经生成的位置
+static void CpuJitEmitJumpTo(CPUJit* jit, size_t target) {
+    CpuJitEmitByte(jit, 0xe9);
+    CpuJitEmit32(jit, (uint32_t)(int32_t)(target - (jit->codeUsed + 4)));
+}
+
+// 向后跳过一小段代码的 jcc rel8，返回需要 CpuJitPatchShort 的位置
+static size_t CpuJitEmitShortJump(CPUJit* jit, uint8_t condition) {
+    CpuJitEmitByte(jit, 0x70 | condition);
+    CpuJitEmitByte(jit, 0);
+    return jit->codeUsed;
+}
+
+static void CpuJitPatchShort(CPUJit* jit, size_t position) {
+    size_t distance = jit->codeUsed - position;
+    assert(distance < 0x80);
+    jit->code[position - 1] = (uint8_t)distance;
+}
+
+static void CpuJitAddFixup(CPUJitAssembler* assembler, uint8_t kind, uint8_t index) {
+    assert(assembler->fixupCount < CPU_JIT_MAX_FIXUPS);
+    CPUJitFixup* fixup = &assembler->fixups[assembler->fixupCount++];
+    fixup->position = (uint32_t)assembler->jit->codeUsed;
+    fixup->kind = kind;
+    fixup->index = index;
+    CpuJitEmit32(assembler->jit, 0);
+}
+
+// 条件成立时在当前指令之前退出，cpu->pc 指向这条指令，由解释器执行
+static void CpuJitEmitExit(CPUJitAssembler* assembler, uint8_t condition) {
+    CpuJitEmitByte(assembler->jit, 0x0f);
+    CpuJitEmitByte(assembler->jit, 0x80 | condition);
+    assembler->exits[assembler->index] = true;
+    CpuJitAddFixup(assembler, CPUJitFixupExit, assembler->index);
+}
+
+// 跳到 pc 所在的指令，不在代码段中时设置 pc 后退出
+static void CpuJitEmitJump(CPUJitAssembler* assembler, ADDR pc) {
+    for (uint8_t i = 0; i < assembler->count; ++i) {
+        if (assembler->instructions[i].pc == pc) {
+            CpuJitEmitByte(assembler->jit, 0xe9);
+            CpuJitAddFixup(assembler, CPUJitFixupLabel, i);
+            return;
+        }
+    }
+    CpuJitEmitSetPC(assembler->jit, pc);
+    CpuJitEmitJumpTo(assembler->jit, assembler->epilogue);
+}
+
+// 内部 RAM 中解码过的代码被改写时由解释器执行写入，见 INesInstanceWrite
+static void CpuJitEmitCheckRAMCode(CPUJitAssembler* assembler, CPUJitMemory flag) {
+    CpuJitEmitMemory(assembler->jit, 0x80, 7, flag);                                   // cmp byte [flag], 0
+    CpuJitEmitByte(assembler->jit, 0);
+    CpuJitEmitExit(assembler, CPUJitConditionNE);
+}
+
+static CPUJitMemory CpuJitRAMCodePage(uint8_t index, uint32_t page) {
+    return { CPUJitRDI, index, 0, (int32_t)(offsetof(CPU2A03, blockCache) + offsetof(CPUBlockCache, RAMCodePage) + page) };
+}
+
+// r11 = 页表中的页，为 NULL（I/O 或 mapper）时退出。读改写要求读写的页相同
+static void CpuJitEmitLookupPage(CPUJitAssembler* assembler, uint8_t access, uint8_t index, uint32_t page) {
+    CPUJit* jit = assembler->jit;
+    size_t pages = access == CPUJitAccessWrite ? offsetof(INesInstance, writePages) : offsetof(INesInstance, readPages);
+    CPUJitMemory memory = { CPUJitRSI, index, 3, (int32_t)(pages + page * sizeof(uint8_t*)) };
+    CpuJitEmitMemory(jit, CPU_JIT_OP_64 | 0x8b, CPUJitR11, memory);                     // mov r11, [pages]
+    if (access == CPUJitAccessModify) {
+        memory.disp = (int32_t)(offsetof(INesInstance, writePages) + page * sizeof(uint8_t*));
+        CpuJitEmitMemory(jit, CPU_JIT_OP_64 | 0x3b, CPUJitR11, memory);                 // cmp r11, [writePages]
+        CpuJitEmitExit(assembler, CPUJitConditionNE);
+    }
+    CpuJitEmitRegister(jit, CPU_JIT_OP_64 | 0x85, CPUJitR11, CPUJitR11);              // test r11, r11
+    CpuJitEmitExit(assembler, CPUJitConditionE);
+}
+
+// edx 为目标地址，ramOnly 表示一定在内部 RAM 中
+static CPUJitMemory CpuJitEmitDynamicAddress(CPUJitAssembler* assembler, uint8_t access, bool ramOnly) {
+    CPUJit* jit = assembler->jit;
+    CpuJitEmitRegister(jit, 0x89, CPUJitRDX, CPUJitRCX);                               // mov ecx, edx
+    CpuJitEmitShift(jit, 5, CPUJitRCX, 8);                                              // shr ecx, 8
+    if (access != CPUJitAccessRead) {
+        size_t skip = 0;
+        if (!ramOnly) {
+            CpuJitEmitArithmeticImm(jit, 7, CPUJitRCX, 0x20);                           // cmp ecx, 0x20
+            skip = CpuJitEmitShortJump(jit, CPUJitConditionAE);
+        }
+        CpuJitEmitCheckRAMCode(assembler, CpuJitRAMCodePage(CPUJitRCX, 0));
+        if (!ramOnly) {
+            CpuJitPatchShort(jit, skip);
+        }
+    }
+    if (ramOnly) {
+        CPUJitMemory memory = { CPUJitRSI, CPUJitRDX, 0, (int32_t)offsetof(INesInstance, mem) };
+        CpuJitEmitMemory(jit, CPU_JIT_OP_64 | 0x8d, CPUJitR11, memory);                 // lea r11, [rsi + rdx + mem]
+    } else {
+        CpuJitEmitLookupPage(assembler, access, CPUJitRCX, 0);
+        CpuJitEmitRegister(jit, CPU_JIT_OP_0F | 0xb6, CPUJitRDX, CPUJitRDX);            // movzx edx, dl
+        CpuJitEmitRegister(jit, CPU_JIT_OP_64 | 0x01, CPUJitRDX, CPUJitR11);            // add r11, rdx
+    }
+    return { CPUJitR11, CPUJitNoIndex, 0, 0 };
+}
+
+// 生成寻址和检查，返回操作数的位置。cross 为 true 时 eax 为是否跨页
+static CPUJitMemory CpuJitEmitAddress(CPUJitAssembler* assembler, const CPUInstruction* info, uint8_t access, bool* cross) {
+    CPUJit* jit = assembler->jit;
+    uint16_t operand = assembler->instructions[assembler->index].operand;
+    *cross = false;
+    switch (info->mode) {
+        case CPUAddressingZeroPage:
+            if (access != CPUJitAccessRead) {
+                CpuJitEmitCheckRAMCode(assembler, CpuJitRAMCodePage(CPUJitNoIndex, 0));
+            }
+            return CpuJitRAM(operand & 0xff);
+        case CPUAddressingZeroPageX:
+        case CPUAddressingZeroPageY: {
+            size_t reg = info->mode == CPUAddressingZeroPageX ? offsetof(CPU2A03, registerX) : offsetof(CPU2A03, registerY);
+            if (access != CPUJitAccessRead) {
+                CpuJitEmitCheckRAMCode(assembler, CpuJitRAMCodePage(CPUJitNoIndex, 0));
+            }
+            CpuJitEmitLoad(jit, CPUJitRDX, CpuJitField(reg));
+            CpuJitEmitArithmeticImm(jit, 0, CPUJitRDX, operand & 0xff);                 // add edx, zp
+            CpuJitEmitRegister(jit, CPU_JIT_OP_0F | 0xb6, CPUJitRDX, CPUJitRDX);        // movzx edx, dl
+            CPUJitMemory memory = { CPUJitRSI, CPUJitRDX, 0, (int32_t)offsetof(INesInstance, mem) };
+            CpuJitEmitMemory(jit, CPU_JIT_OP_64 | 0x8d, CPUJitR11, memory);             // lea r11, [rsi + rdx + mem]
+            return { CPUJitR11, CPUJitNoIndex, 0, 0 };
+        }
+        case CPUAddressingAbsolute: {
+            uint32_t page = operand >> 8;
+            if (page < 0x40 && page != 0x20) {
+                if (access != CPUJitAccessRead && page < 0x20) {
+                    CpuJitEmitCheckRAMCode(assembler, CpuJitRAMCodePage(CPUJitNoIndex, page));
+                }
+                return CpuJitRAM(operand);
+            }
+            CpuJitEmitLookupPage(assembler, access, CPUJitNoIndex, page);
+            return { CPUJitR11, CPUJitNoIndex, 0, (int32_t)(operand & 0xff) };
+        }
+        case CPUAddressingAbsoluteX:
+        case CPUAddressingAbsoluteY: {
+            size_t reg = info->mode == CPUAddressingAbsoluteX ? offsetof(CPU2A03, registerX) : offsetof(CPU2A03, registerY);
+            CpuJitEmitLoad(jit, CPUJitRAX, CpuJitField(reg));
+            CpuJitEmitArithmeticImm(jit, 0, CPUJitRAX, operand & 0xff);                 // add eax, low
+            CpuJitEmitMemory(jit, 0x8d, CPUJitRDX, { CPUJitRAX, CPUJitNoIndex, 0, (int32_t)(operand & 0xff00) }); // lea edx, [rax + high]
+            CpuJitEmitRegister(jit, CPU_JIT_OP_0F | 0xb7, CPUJitRDX, CPUJitRDX);        // movzx edx, dx
+            CpuJitEmitShift(jit, 5, CPUJitRAX, 8);                                      // shr eax, 8
+            *cross = true;
+            return CpuJitEmitDynamicAddress(assembler, access, (uint32_t)operand + 0xff < 0x2000);
+        }
+        case CPUAddressingIndirectX: {
+            CpuJitEmitLoad(jit, CPUJitRAX, CpuJitField(offsetof(CPU2A03, registerX)));
+            CpuJitEmitArithmeticImm(jit, 0, CPUJitRAX, operand & 0xff);                 // add eax, zp
+            CpuJitEmitRegister(jit, CPU_JIT_OP_0F | 0xb6, CPUJitRAX, CPUJitRAX);        // movzx eax, al
+            CpuJitEmitLoad(jit, CPUJitRDX, { CPUJitRSI, CPUJitRAX, 0, (int32_t)offsetof(INesInstance, mem) });
+            CpuJitEmitArithmeticImm(jit, 0, CPUJitRAX, 1);                              // add eax, 1
+            CpuJitEmitRegister(jit, CPU_JIT_OP_0F | 0xb6, CPUJitRAX, CPUJitRAX);        // movzx eax, al
+            CpuJitEmitLoad(jit, CPUJitRAX, { CPUJitRSI, CPUJitRAX, 0, (int32_t)offsetof(INesInstance, mem) });
+            CpuJitEmitShift(jit, 4, CPUJitRAX, 8);                                      // shl eax, 8
+            CpuJitEmitRegister(jit, 0x09, CPUJitRAX, CPUJitRDX);                        // or edx, eax
+            return CpuJitEmitDynamicAddress(assembler, access, false);
+        }
+        case CPUAddressingIndirectY: {
+            CpuJitEmitLoad(jit, CPUJitRDX, CpuJitRAM(operand & 0xff));
+            CpuJitEmitLoad(jit, CPUJitRCX, CpuJitRAM((operand + 1) & 0xff));
+            CpuJitEmitLoad(jit, CPUJitRAX, CpuJitField(offsetof(CPU2A03, registerY)));
+            CpuJitEmitRegister(jit, 0x01, CPUJitRDX, CPUJitRAX);                        // add eax, edx
+            CpuJitEmitShift(jit, 4, CPUJitRCX, 8);                                      // shl ecx, 8
+            CpuJitEmitMemory(jit, 0x8d, CPUJitRDX, { CPUJitRCX, CPUJitRAX, 0, 0 });     // lea edx, [rcx + rax]
+            CpuJitEmitRegister(jit, CPU_JIT_OP_0F | 0xb7, CPUJitRDX, CPUJitRDX);        // movzx edx, dx
+            CpuJitEmitShift(jit, 5, CPUJitRAX, 8);                                      // shr eax, 8
+            *cross = true;
+            return CpuJitEmitDynamicAddress(assembler, access, false);
+        }
+        default:
+            assert(false);
+            return CpuJitField(offsetof(CPU2A03, registerA));
+    }
+}
+
+// ecx 为操作数，与 NesCPUHandlers.hpp 中的 CpuExecute* 相同
+static void CpuJitEmitRead(CPUJit* jit, uint8_t operation) {
+    CPUJitMemory a = CpuJitField(offsetof(CPU2A03, registerA));
+    CPUJitMemory flagC = CpuJitField(offsetof(CPU2A03, flagC));
+    CPUJitMemory flagV = CpuJitField(offsetof(CPU2A03, flagV));
+    switch (operation) {
+        case CPUJitOperationLDA:
+        case CPUJitOperationLDX:
+        case CPUJitOperationLDY:
+        case CPUJitOperationLAX:
+            if (operation == CPUJitOperationLDA || operation == CPUJitOperationLAX) {
+                CpuJitEmitStore(jit, CPUJitRCX, a);
+            }
+            if (operation == CPUJitOperationLDX || operation == CPUJitOperationLAX) {
+                CpuJitEmitStore(jit, CPUJitRCX, CpuJitField(offsetof(CPU2A03, registerX)));
+            }
+            if (operation == CPUJitOperationLDY) {
+                CpuJitEmitStore(jit, CPUJitRCX, CpuJitField(offsetof(CPU2A03, registerY)));
+            }
+            CpuJitEmitFlagZN(jit, CPUJitRCX);
+            break;
+        case CPUJitOperationORA:
+        case CPUJitOperationAND:
+        case CPUJitOperationEOR:
+            CpuJitEmitLoad(jit, CPUJitRAX, a);
+            CpuJitEmitRegister(jit, operation == CPUJitOperationORA ? 0x09 : operation == CPUJitOperationAND ? 0x21 : 0x31,
+                               CPUJitRCX, CPUJitRAX);                                   // or/and/xor eax, ecx
+            CpuJitEmitStore(jit, CPUJitRAX, a);
+            CpuJitEmitFlagZN(jit, CPUJitRAX);
+            break;
+        case CPUJitOperationADC:
+        case CPUJitOperationSBC:
+            CpuJitEmitLoad(jit, CPUJitRAX, a);
+            if (operation == CPUJitOperationADC) {
+                CpuJitEmitLoad(jit, CPUJitRDX, flagC);
+                CpuJitEmitRegister(jit, 0xf7, 3, CPUJitRDX);                            // neg edx，CF = C
+                CpuJitEmitRegister(jit, 0x10, CPUJitRCX, CPUJitRAX);                    // adc al, cl
+            } else {
+                CpuJitEmitMemory(jit, 0x80, 7, flagC);                                  // cmp byte [flagC], 1，CF = !C
+                CpuJitEmitByte(jit, 1);
+                CpuJitEmitRegister(jit, 0x18, CPUJitRCX, CPUJitRAX);                    // sbb al, cl
+            }
+            CpuJitEmitRegister(jit, CPU_JIT_OP_0F | (0x90 | CPUJitConditionO), 0, CPUJitRDX);   // seto dl
+            CpuJitEmitMemory(jit, CPU_JIT_OP_0F | (0x90 | (operation == CPUJitOperationADC ? CPUJitConditionB : CPUJitConditionAE)),
+                             0, flagC);                                                 // setc/setnc byte [flagC]
+            CpuJitEmitStore(jit, CPUJitRAX, a);
+            CpuJitEmitRegister(jit, CPU_JIT_OP_0F | 0xb6, CPUJitRAX, CPUJitRAX);        // movzx eax, al
+            CpuJitEmitFlagZN(jit, CPUJitRAX);
+            // CpuExecuteADC/SBC 在结果为 0 时（-128 + -128 或 -128 - 127 - 1）不设置 V
+            CpuJitEmitRegister(jit, 0x85, CPUJitRAX, CPUJitRAX);                        // test eax, eax
+            CpuJitEmitRegister(jit, CPU_JIT_OP_0F | (0x90 | CPUJitConditionNE), 0, CPUJitRCX);  // setne cl
+            CpuJitEmitRegister(jit, 0x20, CPUJitRCX, CPUJitRDX);                        // and dl, cl
+            CpuJitEmitStore(jit, CPUJitRDX, flagV);
+            break;
+        case CPUJitOperationCMP:
+        case CPUJitOperationCPX:
+        case CPUJitOperationCPY: {
+            size_t reg = operation == CPUJitOperationCMP ? offsetof(CPU2A03, registerA) :
+                         operation == CPUJitOperationCPX ? offsetof(CPU2A03, registerX) : offsetof(CPU2A03, registerY);
+            CpuJitEmitLoad(jit, CPUJitRAX, CpuJitField(reg));
+            CpuJitEmitRegister(jit, 0x39, CPUJitRCX, CPUJitRAX);                        // cmp eax, ecx
+            CpuJitEmitMemory(jit, CPU_JIT_OP_0F | (0x90 | CPUJitConditionAE), 0, flagC);   // setae byte [flagC]
+            CpuJitEmitRegister(jit, 0x29, CPUJitRCX, CPUJitRAX);                        // sub eax, ecx
+            CpuJitEmitRegister(jit, CPU_JIT_OP_0F | 0xb6, CPUJitRAX, CPUJitRAX);        // movzx eax, al
+            CpuJitEmitFlagZN(jit, CPUJitRAX);
+            break;
+        }
+        case CPUJitOperationBIT:
+            CpuJitEmitLoad(jit, CPUJitRAX, a);
+            CpuJitEmitRegister(jit, 0x21, CPUJitRCX, CPUJitRAX);                        // and eax, ecx
+            CpuJitEmitRegister(jit, 0x89, CPUJitRCX, CPUJitRDX);                        // mov edx, ecx
+            CpuJitEmitArithmeticImm(jit, 4, CPUJitRDX, 0x80);                           // and edx, 0x80
+            CpuJitEmitShift(jit, 4, CPUJitRDX, 1);                                      // shl edx, 1
+            CpuJitEmitRegister(jit, 0x09, CPUJitRDX, CPUJitRAX);                        // or eax, edx
+            CpuJitEmitFlagZN(jit, CPUJitRAX);
+            CpuJitEmitShift(jit, 5, CPUJitRCX, 6);                                      // shr ecx, 6
+            CpuJitEmitArithmeticImm(jit, 4, CPUJitRCX, 1);                              // and ecx, 1
+            CpuJitEmitStore(jit, CPUJitRCX, flagV);
+            break;
+        default:
+            assert(false);
+            break;
+    }
+}
+
+// ecx 为操作数，结果零扩展后留在 ecx 中
+static void CpuJitEmitModify(CPUJit* jit, uint8_t operation) {
+    CPUJitMemory flagC = CpuJitField(offsetof(CPU2A03, flagC));
+    switch (operation) {
+        case CPUJitOperationASL:
+            CpuJitEmitRegister(jit, 0x89, CPUJitRCX, CPUJitRAX);                        // mov eax, ecx
+            CpuJitEmitShift(jit, 5, CPUJitRAX, 7);                                      // shr eax, 7
+            CpuJitEmitStore(jit, CPUJitRAX, flagC);
+            CpuJitEmitRegister(jit, 0x01, CPUJitRCX, CPUJitRCX);                        // add ecx, ecx
+            break;
+        case CPUJitOperationLSR:
+            CpuJitEmitRegister(jit, 0x89, CPUJitRCX, CPUJitRAX);                        // mov eax, ecx
+            CpuJitEmitArithmeticImm(jit, 4, CPUJitRAX, 1);                              // and eax, 1
+            CpuJitEmitStore(jit, CPUJitRAX, flagC);
+            CpuJitEmitShift(jit, 5, CPUJitRCX, 1);                                      // shr ecx, 1
+            break;
+        case CPUJitOperationROL:
+            CpuJitEmitLoad(jit, CPUJitRAX, flagC);
+            CpuJitEmitRegister(jit, 0x89, CPUJitRCX, CPUJitRDX);                        // mov edx, ecx
+            CpuJitEmitShift(jit, 5, CPUJitRDX, 7);                                      // shr edx, 7
+            CpuJitEmitStore(jit, CPUJitRDX, flagC);
+            CpuJitEmitRegister(jit, 0x01, CPUJitRCX, CPUJitRCX);                        // add ecx, ecx
+            CpuJitEmitRegister(jit, 0x09, CPUJitRAX, CPUJitRCX);                        // or ecx, eax
+            break;
+        case CPUJitOperationROR:
+            CpuJitEmitLoad(jit, CPUJitRAX, flagC);
+            CpuJitEmitShift(jit, 4, CPUJitRAX, 7);                                      // shl eax, 7
+            CpuJitEmitRegister(jit, 0x89, CPUJitRCX, CPUJitRDX);                        // mov edx, ecx
+            CpuJitEmitArithmeticImm(jit, 4, CPUJitRDX, 1);                              // and edx, 1
+            CpuJitEmitStore(jit, CPUJitRDX, flagC);
+            CpuJitEmitShift(jit, 5, CPUJitRCX, 1);                                      // shr ecx, 1
+            CpuJitEmitRegister(jit, 0x09, CPUJitRAX, CPUJitRCX);                        // or ecx, eax
+            break;
+        case CPUJitOperationINC:
+        case CPUJitOperationINX:
+        case CPUJitOperationINY:
+            CpuJitEmitArithmeticImm(jit, 0, CPUJitRCX, 1);                              // add ecx, 1
+            break;
+        case CPUJitOperationDEC:
+        case CPUJitOperationDEX:
+        case CPUJitOperationDEY:
+            CpuJitEmitArithmeticImm(jit, 5, CPUJitRCX, 1);                              // sub ecx, 1
+            break;
+        default:
+            assert(false);
+            break;
+    }
+    CpuJitEmitRegister(jit, CPU_JIT_OP_0F | 0xb6, CPUJitRCX, CPUJitRCX);                // movzx ecx, cl
+}
+
+// 条件分支：跳转时额外 1 个时钟，跨页再加 1 个
+static void CpuJitEmitBranch(CPUJitAssembler* assembler, const CPUDecodedInstruction* decoded) {
+    CPUJit* jit = assembler->jit;
+    uint8_t taken = CPUJitConditionNE;
+    switch (decoded->opcode) {
+        case CORE_CODE_BCC:
+        case CORE_CODE_BCS:
+            CpuJitEmitMemory(jit, 0x80, 7, CpuJitField(offsetof(CPU2A03, flagC)));     // cmp byte [flagC], 0
+            CpuJitEmitByte(jit, 0);
+            taken = decoded->opcode == CORE_CODE_BCS ? CPUJitConditionNE : CPUJitConditionE;
+            break;
+        case CORE_CODE_BEQ:
+        case CORE_CODE_BNE:
+            CpuJitEmitMemory(jit, 0x80, 7, CpuJitField(offsetof(CPU2A03, flagNZ)));    // cmp byte [flagNZ], 0，Z 只看低 8 位
+            CpuJitEmitByte(jit, 0);
+            taken = decoded->opcode == CORE_CODE_BEQ ? CPUJitConditionE : CPUJitConditionNE;
+            break;
+        case CORE_CODE_BMI:
+        case CORE_CODE_BPL:
+            CpuJitEmitMemory(jit, CPU_JIT_OP_16 | 0xf7, 0, CpuJitField(offsetof(CPU2A03, flagNZ)));   // test word [flagNZ], 0x180
+            CpuJitEmit16(jit, 0x180);
+            taken = decoded->opcode == CORE_CODE_BMI ? CPUJitConditionNE : CPUJitConditionE;
+            break;
+        case CORE_CODE_BVC:
+        case CORE_CODE_BVS:
+            CpuJitEmitMemory(jit, 0x80, 7, CpuJitField(offsetof(CPU2A03, flagV)));     // cmp byte [flagV], 0
+            CpuJitEmitByte(jit, 0);
+            taken = decoded->opcode == CORE_CODE_BVS ? CPUJitConditionNE : CPUJitConditionE;
+            break;
+        default:
+            assert(false);
+            break;
+    }
+    size_t skip = CpuJitEmitShortJump(jit, taken ^ 1);
+    ADDR next = decoded->pc + 2;
+    ADDR target = next + (int8_t)decoded->operand;
+    uint8_t penalty = (target & 0xff00) == (next & 0xff00) ? 1 : 2;
+    CpuJitEmitByte(jit, 0x41);                                                          // mov r9d, penalty
+    CpuJitEmitByte(jit, 0xb8 | (CPUJitR9 & 7));
+    CpuJitEmit32(jit, penalty);
+    CpuJitEmitArithmeticImm(jit, 5, CPUJitR8, penalty);                                 // sub r8d, penalty
+    CpuJitEmitJump(assembler, target);
+    CpuJitPatchShort(jit, skip);
+}
+
+static void CpuJitEmitInstruction(CPUJitAssembler* assembler) {
+    CPUJit* jit = assembler->jit;
+    const CPUDecodedInstruction* decoded = &assembler->instructions[assembler->index];
+    const CPUInstruction* info = GetCPUInstructionBook(NULL) + decoded->opcode;
+    const CPUJitMnemonic* mnemonic = CpuJitGetMnemonic(info);
+    uint8_t operation = mnemonic->operation;
+
+    assembler->labels[assembler->index] = jit->codeUsed;
+    if (assembler->targets[assembler->index]) {
+        assembler->penaltyZero = false;
+    }
+    // 在指令开始的时钟检查 NMI/IRQ 之前，已经没有剩余的时钟时退出
+    CpuJitEmitRegister(jit, 0x85, CPUJitR8, CPUJitR8);                                 // test r8d, r8d
+    CpuJitEmitExit(assembler, CPUJitConditionLE);
+
+    // 寻址和所有可能退出的检查
+    uint8_t access = mnemonic->access;
+    bool cross = false;
+    CPUJitMemory memory = CpuJitField(offsetof(CPU2A03, registerA));
+    if (info->mode == CPUAddressingImmediate || info->mode == CPUAddressingAccumulator) {
+        access = CPUJitAccessNone;
+    } else if (access != CPUJitAccessNone) {
+        memory = CpuJitEmitAddress(assembler, info, access, &cross);
+    } else if (info->mode == CPUAddressingAbsoluteX || info->mode == CPUAddressingAbsoluteY) {
+        // 非官方的 NOP 不读取操作数，但跨页的时钟和解释器一致
+        size_t reg = info->mode == CPUAddressingAbsoluteX ? offsetof(CPU2A03, registerX) : offsetof(CPU2A03, registerY);
+        CpuJitEmitLoad(jit, CPUJitRAX, CpuJitField(reg));
+        CpuJitEmitArithmeticImm(jit, 0, CPUJitRAX, decoded->operand & 0xff);          // add eax, low
+        CpuJitEmitShift(jit, 5, CPUJitRAX, 8);                                          // shr eax, 8
+        cross = true;
+    }
+    if (operation == CPUJitOperationPHA) {
+        CpuJitEmitCheckRAMCode(assembler, CpuJitRAMCodePage(CPUJitNoIndex, 1));
+    }
+
+    // 之后不再退出，r9d 改为这条指令的额外时钟
+    if (cross && info->crossPageType) {
+        CpuJitEmitRegister(jit, 0x89, CPUJitRAX, CPUJitR9);                            // mov r9d, eax
+        CpuJitEmitRegister(jit, 0x29, CPUJitRAX, CPUJitR8);                            // sub r8d, eax
+        assembler->penaltyZero = false;
+    } else if (!assembler->penaltyZero) {
+        CpuJitEmitRegister(jit, 0x31, CPUJitR9, CPUJitR9);                             // xor r9d, r9d
+        assembler->penaltyZero = true;
+    }
+    CpuJitEmitArithmeticImm(jit, 5, CPUJitR8, info->cycle);                            // sub r8d, cycle
+
+    CPUJitMemory stack = { CPUJitRSI, CPUJitRDX, 0, (int32_t)(offsetof(INesInstance, mem) + 0x100) };
+    CPUJitMemory sp = CpuJitField(offsetof(CPU2A03, stackPointer));
+    switch (operation) {
+        case CPUJitOperationLDA:
+        case CPUJitOperationLDX:
+        case CPUJitOperationLDY:
+        case CPUJitOperationLAX:
+        case CPUJitOperationORA:
+        case CPUJitOperationAND:
+        case CPUJitOperationEOR:
+        case CPUJitOperationADC:
+        case CPUJitOperationSBC:
+        case CPUJitOperationCMP:
+        case CPUJitOperationCPX:
+        case CPUJitOperationCPY:
+        case CPUJitOperationBIT:
+            if (info->mode == CPUAddressingImmediate) {
+                CpuJitEmitByte(jit, 0xb8 | CPUJitRCX);                                  // mov ecx, imm
+                CpuJitEmit32(jit, decoded->operand & 0xff);
+            } else {
+                CpuJitEmitLoad(jit, CPUJitRCX, memory);
+            }
+            CpuJitEmitRead(jit, operation);
+            break;
+        case CPUJitOperationSTA:
+        case CPUJitOperationSTX:
+        case CPUJitOperationSTY:
+        case CPUJitOperationSAX: {
+            size_t reg = operation == CPUJitOperationSTX ? offsetof(CPU2A03, registerX) :
+                         operation == CPUJitOperationSTY ? offsetof(CPU2A03, registerY) : offsetof(CPU2A03, registerA);
+            CpuJitEmitLoad(jit, CPUJitRCX, CpuJitField(reg));
+            if (operation == CPUJitOperationSAX) {
+                CpuJitEmitMemory(jit, 0x22, CPUJitRCX, CpuJitField(offsetof(CPU2A03, registerX)));    // and cl, [X]
+            }
+            CpuJitEmitStore(jit, CPUJitRCX, memory);
+            break;
+        }
+        case CPUJitOperationASL:
+        case CPUJitOperationLSR:
+        case CPUJitOperationROL:
+        case CPUJitOperationROR:
+        case CPUJitOperationINC:
+        case CPUJitOperationDEC:
+        case CPUJitOperationINX:
+        case CPUJitOperationINY:
+        case CPUJitOperationDEX:
+        case CPUJitOperationDEY:
+            if (operation == CPUJitOperationINX || operation == CPUJitOperationDEX) {
+                memory = CpuJitField(offsetof(CPU2A03, registerX));
+            } else if (operation == CPUJitOperationINY || operation == CPUJitOperationDEY) {
+                memory = CpuJitField(offsetof(CPU2A03, registerY));
+            }
+            CpuJitEmitLoad(jit, CPUJitRCX, memory);
+            CpuJitEmitModify(jit, operation);
+            CpuJitEmitStore(jit, CPUJitRCX, memory);
+            CpuJitEmitFlagZN(jit, CPUJitRCX);
+            break;
+        case CPUJitOperationTAX:
+        case CPUJitOperationTAY:
+        case CPUJitOperationTXA:
+        case CPUJitOperationTYA:
+        case CPUJitOperationTSX:
+        case CPUJitOperationTXS: {
+            static const size_t from[] = {
+                offsetof(CPU2A03, registerA), offsetof(CPU2A03, registerA), offsetof(CPU2A03, registerX),
+                offsetof(CPU2A03, registerY), offsetof(CPU2A03, stackPointer), offsetof(CPU2A03, registerX),
+            };
+            static const size_t to[] = {
+                offsetof(CPU2A03, registerX), offsetof(CPU2A03, registerY), offsetof(CPU2A03, registerA),
+                offsetof(CPU2A03, registerA), offsetof(CPU2A03, registerX), offsetof(CPU2A03, stackPointer),
+            };
+            uint8_t i = operation - CPUJitOperationTAX;
+            CpuJitEmitLoad(jit, CPUJitRCX, CpuJitField(from[i]));
+            CpuJitEmitStore(jit, CPUJitRCX, CpuJitField(to[i]));
+            if (operation != CPUJitOperationTXS) {
+                CpuJitEmitFlagZN(jit, CPUJitRCX);
+            }
+            break;
+        }
+        case CPUJitOperationCLC:
+        case CPUJitOperationSEC:
+            CpuJitEmitStoreImm(jit, CpuJitField(offsetof(CPU2A03, flagC)), operation == CPUJitOperationSEC ? 1 : 0);
+            break;
+        case CPUJitOperationCLV:
+            CpuJitEmitStoreImm(jit, CpuJitField(offsetof(CPU2A03, flagV)), 0);
+            break;
+        case CPUJitOperationCLD:
+            CpuJitEmitMemory(jit, 0x80, 4, CpuJitField(offsetof(CPU2A03, p)));         // and byte [p], ~D
+            CpuJitEmitByte(jit, (uint8_t)~CPU_FLAG_D);
+            break;
+        case CPUJitOperationSED:
+            CpuJitEmitMemory(jit, 0x80, 1, CpuJitField(offsetof(CPU2A03, p)));         // or byte [p], D
+            CpuJitEmitByte(jit, CPU_FLAG_D);
+            break;
+        case CPUJitOperationPHA:
+            CpuJitEmitLoad(jit, CPUJitRDX, sp);
+            CpuJitEmitLoad(jit, CPUJitRCX, CpuJitField(offsetof(CPU2A03, registerA)));
+            CpuJitEmitStore(jit, CPUJitRCX, stack);
+            CpuJitEmitMemory(jit, 0xfe, 1, sp);                                         // dec byte [sp]
+            break;
+        case CPUJitOperationPLA:
+            CpuJitEmitMemory(jit, 0xfe, 0, sp);                                         // inc byte [sp]
+            CpuJitEmitLoad(jit, CPUJitRDX, sp);
+            CpuJitEmitLoad(jit, CPUJitRCX, stack);
+            CpuJitEmitStore(jit, CPUJitRCX, CpuJitField(offsetof(CPU2A03, registerA)));
+            CpuJitEmitFlagZN(jit, CPUJitRCX);
+            break;
+        case CPUJitOperationNOP:
+            break;
+        case CPUJitOperationBranch:
+            CpuJitEmitBranch(assembler, decoded);
+            break;
+        case CPUJitOperationJMP:
+            CpuJitEmitJump(assembler, decoded->operand);
+            break;
+        default:
+            assert(false);
+            break;
+    }
+}
+
+// 生成的函数布局：退出代码共用的结尾、入口、每条指令、顺序执行到末尾时的退出、每条指令之前的退出
+static CpuJitCode CpuJitEmitBlock(CPUJit* jit, const CPUDecodedInstruction* instructions, uint8_t count, ADDR endPC) {
+    CPUJitAssembler* assembler = (CPUJitAssembler*)malloc(sizeof(CPUJitAssembler));
+    memset(assembler, 0, sizeof(CPUJitAssembler));
+    assembler->jit = jit;
+    assembler->instructions = instructions;
+    assembler->count = count;
+    for (uint8_t i = 0; i < count; ++i) {
+        const CPUDecodedInstruction* decoded = &instructions[i];
+        ADDR target = 0;
+        if (decoded->opcode == CORE_CODE_JMP_ABSOLUTE) {
+            target = decoded->operand;
+        } else if ((decoded->opcode & 0x1f) == 0x10) {
+            target = decoded->pc + 2 + (int8_t)decoded->operand;
+        } else {
+            continue;
+        }
+        for (uint8_t j = 0; j < count; ++j) {
+            if (instructions[j].pc == target) {
+                assembler->targets[j] = true;
+            }
+        }
+    }
+
+    // 返回执行的时钟数 r10d - r8d - r9d，即到最后一条指令的基础时钟结束，额外时钟留给下一条指令之前
+    assembler->epilogue = jit->codeUsed;
+    CpuJitEmitMemory(jit, CPU_JIT_OP_64 | 0x89, CPUJitR9, CpuJitField(offsetof(CPU2A03, extraCycle)));    // mov [extraCycle], r9
+    CpuJitEmitRegister(jit, 0x89, CPUJitR10, CPUJitRAX);                               // mov eax, r10d
+    CpuJitEmitRegister(jit, 0x29, CPUJitR8, CPUJitRAX);                                // sub eax, r8d
+    CpuJitEmitRegister(jit, 0x29, CPUJitR9, CPUJitRAX);                                // sub eax, r9d
+    CpuJitEmitByte(jit, 0xc3);                                                          // ret
+
+    CpuJitCode code = (CpuJitCode)(void*)(jit->code + jit->codeUsed);
+    CpuJitEmitRegister(jit, 0x89, CPUJitRDX, CPUJitR10);                               // mov r10d, edx
+    CpuJitEmitMemory(jit, CPU_JIT_OP_64 | 0x8b, CPUJitR9, CpuJitField(offsetof(CPU2A03, extraCycle)));    // mov r9, [extraCycle]
+    CpuJitEmitRegister(jit, 0x89, CPUJitR10, CPUJitR8);                                // mov r8d, r10d
+    CpuJitEmitRegister(jit, 0x29, CPUJitR9, CPUJitR8);                                 // sub r8d, r9d
+
+    for (uint8_t i = 0; i < count; ++i) {
+        assembler->index = i;
+        CpuJitEmitInstruction(assembler);
+    }
+    if (instructions[count - 1].opcode != CORE_CODE_JMP_ABSOLUTE) {
+        CpuJitEmitSetPC(jit, endPC);
+        CpuJitEmitJumpTo(jit, assembler->epilogue);
+    }
+
+    size_t exits[CPU_JIT_MAX_INSTRUCTIONS];
+    for (uint8_t i = 0; i < count; ++i) {
+        if (assembler->exits[i]) {
+            exits[i] = jit->codeUsed;
+            CpuJitEmitSetPC(jit, instructions[i].pc);
+            CpuJitEmitJumpTo(jit, assembler->epilogue);
+        }
+    }
+    for (uint16_t i = 0; i < assembler->fixupCount; ++i) {
+        const CPUJitFixup* fixup = &assembler->fixups[i];
+        size_t target = fixup->kind == CPUJitFixupExit ? exits[fixup->index] : assembler->labels[fixup->index];
+        int32_t rel = (int32_t)(target - (fixup->position + 4));
+        memcpy(jit->code + fixup->position, &rel, 4);
+    }
+    free(assembler);
+    return code;
+}
+
+// 寻址页固定的指令在编译时检查当前的页表，执行时访问的页没有映射（I/O 或 mapper）仍然会退出
+static bool CpuJitCanCompile(INesInstance* instance, const CPUDecodedInstruction* decoded) {
+    const CPUInstruction* info = GetCPUInstructionBook(NULL) + decoded->opcode;
+    const CPUJitMnemonic* mnemonic = CpuJitGetMnemonic(info);
+    if (!mnemonic) {
+        return false;
+    }
+    if (info->mode != CPUAddressingAbsolute || mnemonic->access == CPUJitAccessNone) {
+        return true;
+    }
+    uint32_t page = decoded->operand >> 8;
+    if (page < 0x40 && page != 0x20) {
+        return true;
+    }
+    switch (mnemonic->access) {
+        case CPUJitAccessRead:
+            return instance->readPages[page] != NULL;
+        case CPUJitAccessWrite:
+            return instance->writePages[page] != NULL;
+        default:
+            return instance->readPages[page] != NULL && instance->readPages[page] == instance->writePages[page];
+    }
+}
+
+// 代码缓冲区不同时可写和可执行。Apple 上要求使用 MAP_JIT，通过 pthread_jit_write_protect_np 切换当前线程的权限
+#if defined(__APPLE__) && defined(MAP_JIT)
+#define CPU_JIT_WRITE_PROTECT_NP        1
+#else
+#define CPU_JIT_WRITE_PROTECT_NP        0
+#endif
+
+static void CpuJitSetWritable(CPUJit* jit, bool writable) {
+#if CPU_JIT_WRITE_PROTECT_NP
+    // Intel 的 Mac 上不支持，MAP_JIT 的内存仍然可以用 mprotect 切换
+    if (pthread_jit_write_protect_supported_np()) {
+        pthread_jit_write_protect_np(writable ? 0 : 1);
+        return;
+    }
+#endif
+    mprotect(jit->code, CPU_JIT_CODE_SIZE, writable ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC);
+}
+
+static bool CpuJitAllocate(CPUJit* jit) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    int protection = PROT_READ | PROT_WRITE;
+#if CPU_JIT_WRITE_PROTECT_NP
+    flags |= MAP_JIT;
+    protection |= PROT_EXEC;
+#endif
+    void* buffer = mmap(NULL, CPU_JIT_CODE_SIZE, protection, flags, -1, 0);
+    if (buffer == MAP_FAILED) {
+        jit->native = false;
+        return false;
+    }
+    jit->code = (uint8_t*)buffer;
+    CpuJitSetWritable(jit, false);
+    return true;
+}
+
+static void CpuJitCompile(CPU2A03* cpu, INesInstance* instance, CPUJitBlock* block, ADDR pc) {
+    const CPUInstruction* book = GetCPUInstructionBook(NULL);
+    CPUDecodedInstruction instructions[CPU_JIT_MAX_INSTRUCTIONS];
+    // 与 CPUDecodedBlock 一样不跨越 8KB 的 PRG 窗口，代码段中的分支目标与代码段使用同一个 bank
+    uint32_t limit = (uint32_t)(pc & 0xe000) + 0x2000;
+    uint8_t count = 0;
+    while (count < CPU_JIT_MAX_INSTRUCTIONS) {
+        const CPUDecodedInstruction* decoded = CpuDecodeInstruction(cpu, instance, pc);
+        const CPUInstruction* info = book + decoded->opcode;
+        if ((uint32_t)pc + info->size > limit || !CpuJitCanCompile(instance, decoded)) {
+            break;
+        }
+        // 从分支或 JMP 开始的位置留给解释器，以便检查空转循环（见 CpuDetectIdleLoop）
+        if (count == 0 && CpuIsBlockEnd(decoded->opcode)) {
+            break;
+        }
+        instructions[count++] = *decoded;
+        pc += info->size;
+        if (decoded->opcode == CORE_CODE_JMP_ABSOLUTE) {
+            break;
+        }
+    }
+
+    block->compiled = true;
+    block->count = 0;
+    if (count < 2) {
+        return;
+    }
+
+    CPUJit* jit = cpu->jit;
+    if (!jit->code && !CpuJitAllocate(jit)) {
+        return;
+    }
+    if (jit->codeUsed + CPU_JIT_MAX_BLOCK_BYTES > CPU_JIT_CODE_SIZE) {
+        int32_t key = block->key;
+        CpuJitFlush(jit);
+        block->key = key;
+    }
+    CpuJitSetWritable(jit, true);
+    block->code = CpuJitEmitBlock(jit, instructions, count, pc);
+    CpuJitSetWritable(jit, false);
+    block->count = count;
+}
+
+#endif
+
+bool CpuJitEnable(CPU2A03* cpu, INesInstance* instance) {
+    if (cpu->jit) {
+        return true;
+    }
+    const CPUAOTProgram* program = CpuAOTFindProgram(instance->file);
+    if (!NES_CPU_JIT && !program) {
+        return false;
+    }
+    cpu->jit = (CPUJit*)malloc(sizeof(CPUJit));
+    memset(cpu->jit, 0, sizeof(CPUJit));
+    cpu->jit->program = program;
+    cpu->jit->native = NES_CPU_JIT;
+    CpuJitFlush(cpu->jit);
+    return true;
+}
+
+void CpuJitDestroy(CPU2A03* cpu) {
+    if (!cpu->jit) {
+        return;
+    }
+#if NES_CPU_JIT
+    if (cpu->jit->code) {
+        munmap(cpu->jit->code, CPU_JIT_CODE_SIZE);
+    }
+#endif
+    free(cpu->jit);
+    cpu->jit = NULL;
+}
+
+const CPUJitBlock* CpuJitLookup(CPU2A03* cpu, INesInstance* instance, ADDR pc) {
+    CPUJit* jit = cpu->jit;
+    // 编译的代码段不经过 CpuExecute，追踪或统计时逐条解释执行
+    if (!jit || CpuTraceIsActive(cpu) || cpu->stats) {
+        return NULL;
+    }
+    // 内部 RAM 中的代码可能被改写，只编译 PRG ROM 中的代码
+    int32_t key = CpuCodeKey(cpu, instance, pc);
+    if (key < 0 || (key & CPU_BLOCK_KEY_RAM)) {
+        return NULL;
+    }
+    uint32_t hash = (uint32_t)key ^ ((uint32_t)key >> 13);
+    CPUJitBlock* block = &jit->blocks[hash & (CPU_JIT_CACHE_SIZE - 1)];
+    if (block->key != key) {
+        // 优先使用 AOT 预编译的代码
+        const CPUJitBlock* precompiled = jit->program ? CpuAOTFindBlock(jit->program, key) : NULL;
+        if (precompiled) {
+            *block = *precompiled;
+            return block;
+        }
+        block->key = key;
+        block->hits = 0;
+        block->compiled = false;
+        block->count = 0;
+    }
+    if (!block->compiled) {
+#if NES_CPU_JIT
+        if (!jit->native || ++block->hits < CPU_JIT_HOT_COUNT) {
+            return NULL;
+        }
+        CpuJitCompile(cpu, instance, block, pc);
+#else
+        return NULL;
+#endif
+    }
+    return block->count > 0 ? block : NULL;
+}
+
+uint32_t CpuJitRun(CPU2A03* cpu, INesInstance* instance, const CPUJitBlock* block, uint32_t budget) {
+    assert(!cpu->cacheFlag);
+    long extraCycle = cpu->extraCycle;
+    uint32_t cycles = block->code(cpu, instance, budget);
+    if (cycles == 0) {
+        return 0;
+    }
+    // cycles 包括开始时消耗的 extraCycle，不包括最后一条指令留在 extraCycle 中的额外时钟。
+    // totalClockCount 只有追踪时使用（追踪时不执行编译的代码），这里包括了中间指令的额外时钟
+    cpu->totalCycle += (long)cycles - extraCycle + cpu->extraCycle;
+    cpu->totalClockCount += (long)cycles - extraCycle;
+    cpu->crossPageCycle = 0;
+    CpuProfileOnCycles(cpu);
+    return cycles;
+}
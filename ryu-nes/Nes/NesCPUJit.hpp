@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "NesCPUImpl.hpp"
+
+// 只有 x86-64 的 Linux/macOS 支持 JIT，其它平台上只能使用 AOT 预编译的代码（见 NesCPUAOT.hpp）
+#ifndef NES_CPU_JIT
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+#define NES_CPU_JIT 1
+#else
+#define NES_CPU_JIT 0
+#endif
+#endif
+
+#define CPU_JIT_CACHE_SIZE              (1024)
+#define CPU_JIT_MAX_INSTRUCTIONS        (32)
+#define CPU_JIT_HOT_COUNT               (8)         // 同一位置执行多少次后编译
+#define CPU_JIT_CODE_SIZE               (256 * 1024) // 第一次编译时分配，写满后清空重新编译
+
+// 执行从 cpu->pc 开始的代码段。先消耗 cpu->extraCycle，之后第 c 个时钟开始的指令只有 c < budget 时才执行（NMI/IRQ 在指令开始时检查）。
+// 返回到最后一条指令的基础时钟结束为止的时钟数，包括开始时的 extraCycle 和中间指令跨页、分支的额外时钟，
+// 最后一条指令的额外时钟留在 cpu->extraCycle 中。没有执行任何指令时返回 0，返回时 cpu->pc 为下一条要执行的指令。
+typedef uint32_t (*CpuJitCode)(CPU2A03* cpu, INesInstance* instance, uint32_t budget);
+
+// 一段 PRG ROM 中的代码，编译后不经过 CpuExecute 直接执行。AOT 生成的代码也使用这个结构。
+struct CPUJitBlock {
+    int32_t key;                // 与 CPUDecodedBlock 相同，-1 为空
+    uint16_t hits;
+    bool compiled;
+    uint8_t count;              // 编译后为指令条数，0 表示无法编译
+    CpuJitCode code;
+};
+
+struct CPUAOTProgram;
+
+struct CPUJit {
+    const CPUAOTProgram* program;   // 与当前 PRG ROM 对应的 AOT 预编译代码
+    uint8_t* code;                  // JIT 代码缓冲区，只在生成代码时可写，执行时只读可执行
+    size_t codeUsed;
+    bool native;                    // 支持 JIT，分配代码缓冲区失败后为 false
+    CPUJitBlock blocks[CPU_JIT_CACHE_SIZE];
+};
+
+// AOT 使用：只访问内部 RAM（或不访问内存）且时钟数固定的指令，可以直接调用处理函数整段执行
+bool CpuJitIsPure(uint8_t opcode, uint16_t operand);
+
+// 既没有 JIT 也没有与 ROM 对应的 AOT 代码时返回 false
+bool CpuJitEnable(CPU2A03* cpu, INesInstance* instance);
+void CpuJitDestroy(CPU2A03* cpu);
+
+// 返回从 pc 开始、已经编译的代码段，没有（或还不够热）时返回 NULL
+const CPUJitBlock* CpuJitLookup(CPU2A03* cpu, INesInstance* instance, ADDR pc);
+
+// 执行代码段，budget 见 CpuJitCode，返回执行的时钟数
+uint32_t CpuJitRun(CPU2A03* cpu, INesInstance* instance, const CPUJitBlock* block, uint32_t budget);
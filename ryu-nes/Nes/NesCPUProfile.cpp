@@ -0,0 +1,98 @@
+#include "NesCPUProfile.hpp"
+#include <stdio.h>
+
+void CpuProfileStart(CPU2A03* cpu, uint32_t period) {
+    CpuProfileStop(cpu);
+    CPUProfile* profile = new CPUProfile();
+    profile->period = period ? period : CPU_PROFILE_DEFAULT_PERIOD;
+    profile->nextSample = cpu->totalCycle + profile->period;
+    profile->depth = 0;
+    cpu->profile = profile;
+}
+
+void CpuProfileStop(CPU2A03* cpu) {
+    delete cpu->profile;
+    cpu->profile = NULL;
+}
+
+void CpuProfileEnter(CPU2A03* cpu, INesInstance* instance, enum CPUProfileFrameType type) {
+    CPUProfile* profile = cpu->profile;
+    if (profile->depth < CPU_PROFILE_MAX_DEPTH) {
+        CPUProfileFrame* frame = &profile->frames[profile->depth];
+        frame->key = CpuCodeKey(cpu, instance, cpu->pc);
+        frame->addr = cpu->pc;
+        frame->type = (uint8_t)type;
+        frame->stackPointer = cpu->stackPointer;
+    }
+    if (profile->depth < 0xff) {
+        ++profile->depth;
+    }
+}
+
+void CpuProfileLeave(CPU2A03* cpu) {
+    // 游戏经常压入地址后用 RTS 跳转，或者直接修改 SP，所以不按 RTS 的个数出栈，
+    // 而是弹出所有返回地址已经在 SP 之上的帧
+    CPUProfile* profile = cpu->profile;
+    while (profile->depth > 0) {
+        uint8_t top = profile->depth - 1;
+        if (top < CPU_PROFILE_MAX_DEPTH && profile->frames[top].stackPointer >= cpu->stackPointer) {
+            break;
+        }
+        --profile->depth;
+    }
+}
+
+static uint64_t CpuProfileEncodeFrame(const CPUProfileFrame* frame) {
+    return ((uint64_t)(uint32_t)frame->key << 32) | ((uint64_t)frame->type << 16) | frame->addr;
+}
+
+void CpuProfileSample(CPU2A03* cpu) {
+    CPUProfile* profile = cpu->profile;
+    // 一次跳过多个采样周期时（长指令、DMA、JIT 代码段）按跨过的周期数计数
+    uint64_t weight = (uint64_t)(cpu->totalCycle - profile->nextSample) / profile->period + 1;
+    profile->nextSample += (long)(weight * profile->period);
+
+    uint8_t depth = profile->depth < CPU_PROFILE_MAX_DEPTH ? profile->depth : CPU_PROFILE_MAX_DEPTH;
+    std::vector<uint64_t> stack(depth);
+    for (uint8_t i = 0; i < depth; ++i) {
+        stack[i] = CpuProfileEncodeFrame(&profile->frames[i]);
+    }
+    profile->samples[stack] += weight;
+}
+
+// PRG ROM 中的代码输出所在的 8KB bank，例如 nmi@prg3:$C123，内部 RAM 中的代码输出 ram:$0300
+static void CpuProfileWriteFrame(FILE* file, uint64_t encoded) {
+    static const char* const prefixes[] = { "", "nmi@", "irq@", "brk@" };
+    int32_t key = (int32_t)(uint32_t)(encoded >> 32);
+    uint8_t type = (uint8_t)(encoded >> 16) & 3;
+    uint16_t addr = (uint16_t)encoded;
+    if (key < 0) {
+        fprintf(file, "%s$%04X", prefixes[type], addr);
+    } else if (key & CPU_BLOCK_KEY_RAM) {
+        fprintf(file, "%sram:$%04X", prefixes[type], addr);
+    } else {
+        int32_t offset = key & ((1 << CPU_BLOCK_KEY_WINDOW_SHIFT) - 1);
+        fprintf(file, "%sprg%d:$%04X", prefixes[type], (int)(offset >> 13), addr);
+    }
+}
+
+bool CpuProfileWriteFolded(const CPU2A03* cpu, const char* path) {
+    const CPUProfile* profile = cpu->profile;
+    if (!profile) {
+        return false;
+    }
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    for (const auto& sample : profile->samples) {
+        fprintf(file, "reset");
+        for (uint64_t frame : sample.first) {
+            fputc(';', file);
+            CpuProfileWriteFrame(file, frame);
+        }
+        fprintf(file, " %llu\n", (unsigned long long)sample.second);
+    }
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <vector>
+#include "NesCPUImpl.hpp"
+
+#define CPU_PROFILE_DEFAULT_PERIOD      (1000)      // 默认每 1000 个 CPU 时钟采样一次
+#define CPU_PROFILE_MAX_DEPTH           (64)
+
+enum CPUProfileFrameType {
+    CPUProfileFrameTypeCall = 0,        // JSR
+    CPUProfileFrameTypeNMI = 1,
+    CPUProfileFrameTypeIRQ = 2,
+    CPUProfileFrameTypeBRK = 3
+};
+
+// 影子调用栈中的一帧，key 与 CPUDecodedBlock 相同，用来区分映射到同一地址的不同 PRG bank
+struct CPUProfileFrame {
+    int32_t key;
+    uint16_t addr;
+    uint8_t type;
+    uint8_t stackPointer;               // 压入返回地址之后的 SP，RTS/RTI 使 SP 超过它时出栈
+};
+
+// JSR/RTS/RTI 和 NMI/IRQ 维护影子调用栈，每 period 个 CPU 时钟记录一次当前的调用栈。
+// 只在这些指令和采样时有额外开销，可以在正式运行时一直打开。
+struct CPUProfile {
+    uint32_t period;
+    long nextSample;
+    uint8_t depth;                      // 可能超过 CPU_PROFILE_MAX_DEPTH，超过的帧不记录
+    CPUProfileFrame frames[CPU_PROFILE_MAX_DEPTH];
+    std::map<std::vector<uint64_t>, uint64_t> samples;
+};
+
+// period 为 0 时使用 CPU_PROFILE_DEFAULT_PERIOD，重复调用会清空已有的采样
+void CpuProfileStart(CPU2A03* cpu, uint32_t period);
+void CpuProfileStop(CPU2A03* cpu);
+// 按 flamegraph.pl 等工具使用的 folded 格式写出采样：每行为以 ; 分隔的调用栈和采样数
+bool CpuProfileWriteFolded(const CPU2A03* cpu, const char* path);
+
+void CpuProfileEnter(CPU2A03* cpu, INesInstance* instance, enum CPUProfileFrameType type);
+void CpuProfileLeave(CPU2A03* cpu);
+void CpuProfileSample(CPU2A03* cpu);
+
+// 在 CpuExecute 执行完一条指令之后调用
+static inline void CpuProfileOnExecute(CPU2A03* cpu, INesInstance* instance, uint8_t opcode) {
+    CPUProfile* profile = cpu->profile;
+    if (!profile) {
+        return;
+    }
+    switch (opcode) {
+        case CORE_CODE_JSR:
+            CpuProfileEnter(cpu, instance, CPUProfileFrameTypeCall);
+            break;
+        case CORE_CODE_BRK:
+            CpuProfileEnter(cpu, instance, CPUProfileFrameTypeBRK);
+            break;
+        case CORE_CODE_RTS:
+        case CORE_CODE_RTI:
+            CpuProfileLeave(cpu);
+            break;
+        default:
+            break;
+    }
+    if (cpu->totalCycle >= profile->nextSample) {
+        CpuProfileSample(cpu);
+    }
+}
+
+// 不经过 CpuExecute 推进 totalCycle 的路径（JIT 代码段、跳过的空转循环）调用
+static inline void CpuProfileOnCycles(CPU2A03* cpu) {
+    CPUProfile* profile = cpu->profile;
+    if (profile && cpu->totalCycle >= profile->nextSample) {
+        CpuProfileSample(cpu);
+    }
+}
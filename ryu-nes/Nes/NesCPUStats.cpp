@@ -0,0 +1,92 @@
+#include "NesCPUStats.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void CpuStatsStart(CPU2A03* cpu) {
+    if (!cpu->stats) {
+        cpu->stats = (CPUStats*)malloc(sizeof(CPUStats));
+    }
+    memset(cpu->stats, 0, sizeof(CPUStats));
+}
+
+void CpuStatsStop(CPU2A03* cpu) {
+    free(cpu->stats);
+    cpu->stats = NULL;
+}
+
+const CPUStats* CpuStatsGet(const CPU2A03* cpu) {
+    return cpu->stats;
+}
+
+// JSON 中寻址模式的名字，与 CPUAddressingMode 的顺序相同
+static const char* const g_modeNames[CPUAddressingModeCount] = {
+    "impl", "acc", "immd", "zp", "zpx", "zpy", "abs", "absx", "absy", "ind", "prex", "posty", "rel",
+};
+
+static void CpuStatsWriteCounter(FILE* file, const CPUStatsCounter* counter) {
+    fprintf(file, "\"executions\": %llu, \"cycles\": %llu, \"pageCrossCycles\": %llu, \"stolenCycles\": %llu",
+            (unsigned long long)counter->executions, (unsigned long long)counter->cycles,
+            (unsigned long long)counter->pageCrossCycles, (unsigned long long)counter->stolenCycles);
+}
+
+static void CpuStatsAdd(CPUStatsCounter* sum, const CPUStatsCounter* counter) {
+    sum->executions += counter->executions;
+    sum->cycles += counter->cycles;
+    sum->pageCrossCycles += counter->pageCrossCycles;
+    sum->stolenCycles += counter->stolenCycles;
+}
+
+bool CpuStatsWriteJSON(const CPU2A03* cpu, const char* path) {
+    const CPUStats* stats = cpu->stats;
+    if (!stats) {
+        return false;
+    }
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+
+    const CPUInstruction* book = GetCPUInstructionBook(NULL);
+    CPUStatsCounter modeCounters[CPUAddressingModeCount];
+    bool modeUsed[CPUAddressingModeCount] = {};
+    CPUStatsCounter total;
+    memset(modeCounters, 0, sizeof(modeCounters));
+    memset(&total, 0, sizeof(total));
+
+    fprintf(file, "{\n  \"opcodes\": [");
+    bool first = true;
+    for (int i = 0; i < 0x100; ++i) {
+        const CPUStatsCounter* counter = &stats->opcodes[i];
+        if (counter->executions == 0 && counter->stolenCycles == 0) {
+            continue;
+        }
+        // 无效指令只会有偷取的时钟，计入隐含寻址
+        const char* name = book[i].name ? book[i].name : "invalid";
+        uint8_t mode = book[i].mode;
+        fprintf(file, "%s\n    { \"opcode\": \"0x%02x\", \"name\": \"%s\", \"mode\": \"%s\", ", first ? "" : ",", i, name, g_modeNames[mode]);
+        CpuStatsWriteCounter(file, counter);
+        fprintf(file, " }");
+        first = false;
+
+        modeUsed[mode] = true;
+        CpuStatsAdd(&modeCounters[mode], counter);
+        CpuStatsAdd(&total, counter);
+    }
+    fprintf(file, "\n  ],\n  \"modes\": {");
+    first = true;
+    for (int i = 0; i < CPUAddressingModeCount; ++i) {
+        if (!modeUsed[i]) {
+            continue;
+        }
+        fprintf(file, "%s\n    \"%s\": { ", first ? "" : ",", g_modeNames[i]);
+        CpuStatsWriteCounter(file, &modeCounters[i]);
+        fprintf(file, " }");
+        first = false;
+    }
+    fprintf(file, "\n  },\n  \"total\": { ");
+    CpuStatsWriteCounter(file, &total);
+    fprintf(file, " }\n}\n");
+    fclose(file);
+    return true;
+}
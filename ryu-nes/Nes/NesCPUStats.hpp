@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "NesCPUImpl.hpp"
+
+// 按指令表中的每一项统计的执行次数和时钟数
+struct CPUStatsCounter {
+    uint64_t executions;
+    uint64_t cycles;                    // 包括跨页和分支的额外时钟
+    uint64_t pageCrossCycles;           // crossPageCycle 带来的额外时钟
+    uint64_t stolenCycles;              // 执行这条指令时（或在它之后）被 DMA 偷取的时钟
+};
+
+struct CPUStats {
+    CPUStatsCounter opcodes[0x100];
+};
+
+// 重复调用会清空已有的计数
+void CpuStatsStart(CPU2A03* cpu);
+void CpuStatsStop(CPU2A03* cpu);
+// 没有调用 CpuStatsStart 时返回 NULL
+const CPUStats* CpuStatsGet(const CPU2A03* cpu);
+// 写出每条指令和每种寻址模式的计数
+bool CpuStatsWriteJSON(const CPU2A03* cpu, const char* path);
+
+static inline void CpuStatsRecord(CPU2A03* cpu, uint8_t opcode, uint8_t cycles, uint8_t pageCrossCycles) {
+    CPUStats* stats = cpu->stats;
+    if (!stats) {
+        return;
+    }
+    CPUStatsCounter* counter = &stats->opcodes[opcode];
+    ++counter->executions;
+    counter->cycles += cycles;
+    counter->pageCrossCycles += pageCrossCycles;
+}
+
+static inline void CpuStatsRecordStolen(CPU2A03* cpu, int stolenCycles) {
+    CPUStats* stats = cpu->stats;
+    if (stats) {
+        stats->opcodes[cpu->lastOpCode].stolenCycles += (uint64_t)stolenCycles;
+    }
+}
@@ -0,0 +1,113 @@
+#include "NesCPUTrace.hpp"
+#include <stdio.h>
+#include <string.h>
+
+#if NES_CPU_TRACE
+#include <chrono>
+
+// 与 nestest.log 相同的列：地址、指令字节、助记符、寄存器、PPU 位置和 CPU 时钟数
+static void CpuTraceWriteText(FILE* file, const CPUTraceEntry* entry) {
+    int size = 0;
+    const CPUInstruction* info = GetCPUInstructionBook(&size) + entry->opcode;
+    char bytes[9] = "";
+    if (info->size >= 3) {
+        snprintf(bytes, sizeof(bytes), "%02X %02X %02X", entry->opcode, entry->operand & 0xff, entry->operand >> 8);
+    } else if (info->size == 2) {
+        snprintf(bytes, sizeof(bytes), "%02X %02X", entry->opcode, entry->operand & 0xff);
+    } else {
+        snprintf(bytes, sizeof(bytes), "%02X", entry->opcode);
+    }
+    char mnemonic[4] = "???";
+    if (info->name) {
+        for (int i = 0; i < 3 && info->name[i]; ++i) {
+            mnemonic[i] = (char)(info->name[i] - ('a' <= info->name[i] && info->name[i] <= 'z' ? 'a' - 'A' : 0));
+        }
+    }
+    fprintf(file, "%04X  %-8s  %s  A:%02X X:%02X Y:%02X P:%02X SP:%02X PPU:%3d,%3d CYC:%llu\n",
+            entry->pc, bytes, mnemonic, entry->registerA, entry->registerX, entry->registerY,
+            entry->p, entry->stackPointer, entry->ty, entry->tx, (unsigned long long)entry->cycle);
+}
+
+static void CpuTraceDrain(CPUTrace* trace) {
+    uint64_t tail = trace->tail.load(std::memory_order_relaxed);
+    uint64_t head = trace->head.load(std::memory_order_acquire);
+    while (tail != head) {
+        // 一次写出到缓冲区末尾或 head 为止的连续记录
+        uint64_t index = tail & (CPU_TRACE_CAPACITY - 1);
+        uint64_t count = head - tail;
+        if (count > CPU_TRACE_CAPACITY - index) {
+            count = CPU_TRACE_CAPACITY - index;
+        }
+        const CPUTraceEntry* entries = &trace->entries[index];
+        if (trace->format == CPUTraceFormatBinary) {
+            fwrite(entries, sizeof(CPUTraceEntry), (size_t)count, trace->file);
+        } else {
+            for (uint64_t i = 0; i < count; ++i) {
+                CpuTraceWriteText(trace->file, &entries[i]);
+            }
+        }
+        tail += count;
+        trace->tail.store(tail, std::memory_order_release);
+    }
+}
+
+static void CpuTraceWriterMain(CPUTrace* trace) {
+    while (trace->running.load(std::memory_order_acquire)) {
+        if (trace->head.load(std::memory_order_acquire) == trace->tail.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        CpuTraceDrain(trace);
+    }
+    CpuTraceDrain(trace);
+}
+#endif
+
+bool CpuTraceStart(CPU2A03* cpu, const char* path, enum CPUTraceFormat format) {
+#if NES_CPU_TRACE
+    CpuTraceStop(cpu);
+    FILE* file = fopen(path, format == CPUTraceFormatBinary ? "wb" : "w");
+    if (!file) {
+        return false;
+    }
+    if (format == CPUTraceFormatBinary) {
+        uint8_t header[8] = { 0 };
+        memcpy(header, CPU_TRACE_BINARY_MAGIC, 4);
+        header[4] = CPU_TRACE_BINARY_VERSION;
+        header[5] = (uint8_t)sizeof(CPUTraceEntry);
+        fwrite(header, sizeof(header), 1, file);
+    }
+
+    CPUTrace* trace = new CPUTrace();
+    trace->head.store(0, std::memory_order_relaxed);
+    trace->tail.store(0, std::memory_order_relaxed);
+    trace->cachedTail = 0;
+    trace->format = format;
+    trace->file = file;
+    trace->running.store(true, std::memory_order_release);
+    trace->writer = std::thread(CpuTraceWriterMain, trace);
+    cpu->trace = trace;
+    return true;
+#else
+    (void)cpu;
+    (void)path;
+    (void)format;
+    return false;
+#endif
+}
+
+void CpuTraceStop(CPU2A03* cpu) {
+#if NES_CPU_TRACE
+    CPUTrace* trace = cpu->trace;
+    if (!trace) {
+        return;
+    }
+    cpu->trace = NULL;
+    trace->running.store(false, std::memory_order_release);
+    trace->writer.join();
+    fclose(trace->file);
+    delete trace;
+#else
+    (void)cpu;
+#endif
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include "NesCPUImpl.hpp"
+
+// 指令追踪默认不编译，编译时定义 NES_CPU_TRACE=1 后才能调用 CpuTraceStart 开始记录。
+// 关闭时 CpuTraceRecord 是空函数，CPU 核心中不产生任何代码。
+#ifndef NES_CPU_TRACE
+#define NES_CPU_TRACE 0
+#endif
+
+#if NES_CPU_TRACE
+#include <atomic>
+#include <thread>
+#endif
+
+#define CPU_TRACE_CAPACITY              (1 << 16)   // 环形缓冲区的记录条数，必须是 2 的幂
+#define CPU_TRACE_BINARY_MAGIC          "RNTR"
+#define CPU_TRACE_BINARY_VERSION        (1)
+
+enum CPUTraceFormat {
+    CPUTraceFormatText = 0,             // 与 nestest.log 相同的格式，便于与其它模拟器的日志比较
+    CPUTraceFormatBinary = 1            // 8 字节文件头之后直接写入 CPUTraceEntry
+};
+
+// 指令执行时的状态，PPU 位置与时钟数为 CPU 执行这条指令的时刻
+struct CPUTraceEntry {
+    uint64_t cycle;
+    uint16_t pc;
+    uint16_t operand;
+    uint16_t tx;
+    uint16_t ty;
+    uint8_t opcode;
+    uint8_t registerA;
+    uint8_t registerX;
+    uint8_t registerY;
+    uint8_t p;
+    uint8_t stackPointer;
+    uint8_t reserved[2];
+};
+static_assert(sizeof(CPUTraceEntry) == 24, "binary trace format depends on the entry layout");
+
+#if NES_CPU_TRACE
+// 单生产者单消费者的环形缓冲区：CPU 线程写入 head，后台线程写出到文件后推进 tail。
+// 缓冲区满时（写出文本比模拟慢）等待后台线程，保证记录不丢失。
+struct CPUTrace {
+    CPUTraceEntry entries[CPU_TRACE_CAPACITY];
+    alignas(64) std::atomic<uint64_t> head;
+    uint64_t cachedTail;                // 生产者看到的 tail，只在缓冲区看起来已满时重新读取
+    alignas(64) std::atomic<uint64_t> tail;
+    std::atomic<bool> running;
+    enum CPUTraceFormat format;
+    FILE* file;
+    std::thread writer;
+};
+#else
+struct CPUTrace;
+#endif
+
+// 打开 path 并启动后台写入线程，没有编译追踪或无法打开文件时返回 false
+bool CpuTraceStart(CPU2A03* cpu, const char* path, enum CPUTraceFormat format);
+// 写出缓冲区中剩余的记录后关闭文件
+void CpuTraceStop(CPU2A03* cpu);
+
+static inline bool CpuTraceIsActive(const CPU2A03* cpu) {
+#if NES_CPU_TRACE
+    return cpu->trace != NULL;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+static inline void CpuTraceRecord(CPU2A03* cpu, INesInstance* instance, const CPUDecodedInstruction* decoded) {
+#if NES_CPU_TRACE
+    CPUTrace* trace = cpu->trace;
+    if (!trace) {
+        return;
+    }
+    uint64_t head = trace->head.load(std::memory_order_relaxed);
+    while (head - trace->cachedTail >= CPU_TRACE_CAPACITY) {
+        trace->cachedTail = trace->tail.load(std::memory_order_acquire);
+        if (head - trace->cachedTail >= CPU_TRACE_CAPACITY) {
+            std::this_thread::yield();
+        }
+    }
+    // PPU 的点推迟执行，tx/ty 落后 pendingDots 个点，先追上 CPU 侧的时钟
+    INesPPUSync(instance);
+    CPUTraceEntry* entry = &trace->entries[head & (CPU_TRACE_CAPACITY - 1)];
+    entry->cycle = (uint64_t)cpu->totalClockCount;
+    entry->pc = decoded->pc;
+    entry->operand = decoded->operand;
+    entry->tx = instance->ppu->tx;
+    entry->ty = instance->ppu->ty;
+    entry->opcode = decoded->opcode;
+    entry->registerA = cpu->registerA;
+    entry->registerX = cpu->registerX;
+    entry->registerY = cpu->registerY;
+    entry->p = CpuGetFlags(cpu);
+    entry->stackPointer = cpu->stackPointer;
+    trace->head.store(head + 1, std::memory_order_release);
+#else
+    (void)cpu;
+    (void)instance;
+    (void)decoded;
+#endif
+}
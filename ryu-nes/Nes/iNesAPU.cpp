@@ -243,6 +243,20 @@ void INesAPUTick(INesAPU* apu) {
     INesAPUTriangleTick(apu);
 }
 
+uint32_t INesAPUGetDMCDeadline(const INesAPU* apu) {
+    const INesAPUDMC* dmc = &apu->DMC;
+    if (!dmc->currLength) {
+        return UINT32_MAX;
+    }
+    // bitCount 为 0 之后的下一次 DMC 时钟读取样本。最快的情况下下一次 DMC 时钟就移出一位，之后每 timer + 1 次移出一位
+    uint32_t ticks = 1;
+    if (dmc->bitCount) {
+        ticks = 2 + (uint32_t)(dmc->bitCount - 1) * ((uint32_t)dmc->timer + 1);
+    }
+    // DMC 每 4 个 CPU 时钟执行一次，第一次最早在下一个 CPU 时钟
+    return (ticks - 1) * 4 + 1;
+}
+
 void INesAPUFrame(INesInstance* instance) {
     INesAPU* apu = instance->apu;
     if (apu->stepMode == INesAPUStepMode4Step) {
@@ -125,5 +125,7 @@ void INesAPUWrite(INesAPU* apu, uint16_t addr, uint8_t data);
 uint8_t INesAPURead(INesAPU* apu, uint16_t addr);
 void INesAPUTick(INesAPU* apu);
 void INesAPUFrame(INesInstance* instance);
+// 从下一个 CPU 时钟起，DMC 读取样本（偷取 CPU 时钟）最早发生在第几个时钟，没有播放样本时为 UINT32_MAX
+uint32_t INesAPUGetDMCDeadline(const INesAPU* apu);
 
 #endif /* iNesAPU_hpp */
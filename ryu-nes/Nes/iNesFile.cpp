@@ -5,7 +5,7 @@
 #include <assert.h>
 #include <stdbool.h>
 
-static void INesFileLoadSaveRam(INesFile* iNesFile) {
+void INesFileLoadSaveRam(INesFile* iNesFile) {
     if (!iNesFile->saveRamFilePath || iNesFile->isSaveRamLoad) {
         return;
     }
@@ -80,6 +80,7 @@ void INesFileWriteRam(INesFile* iNesFile, size_t addr, uint8_t data);
 uint8_t INesFileReadRam(INesFile* iNesFile, size_t addr);
 uint8_t INesFileReadRom(INesFile* iNesFile, size_t addr);
 uint8_t INesFileReadChr(INesFile* iNesFile, size_t addr);
+void INesFileLoadSaveRam(INesFile* iNesFile);
 void INesFileSaveRam(INesFile* iNesFile);
 void INesFileDestroy(const INesFile* iNesFile);
 
@@ -4,6 +4,16 @@
 #include <assert.h>
 #include "iNesMapper.hpp"
 #include "iNesPad.hpp"
+#include "NesCPUJit.hpp"
+#include "NesCPUTrace.hpp"
+#include "NesCPUProfile.hpp"
+#include "NesCPUStats.hpp"
+#include "iNesMapperTraits.hpp"
+#include "iNesTileCache.hpp"
+#include "iNesPPUFramebuffer.hpp"
+#include "iNesPPUThread.hpp"
+
+static void INesInstanceSelectFrame(INesInstance* instance);
 
 INesInstance* INesInstanceCreate(const uint8_t* data, size_t size) {
     INesInstance* instance = (INesInstance*)malloc(sizeof(INesInstance));
@@ -26,6 +36,16 @@ INesInstance* INesInstanceCreate(const uint8_t* data, size_t size) {
         }
     }
     
+    // $0000-$1FFF 为内部 RAM，$2008-$3FFF 没有映射 PPU 寄存器，同样直接读写 mem
+    for (uint32_t page = 0x00; page < 0x40; ++page) {
+        if (page != 0x20) {
+            instance->readPages[page] = instance->mem + (page << 8);
+            instance->writePages[page] = instance->mem + (page << 8);
+        }
+    }
+    
+    INesTileCacheCreate(instance);
+    
     instance->mapper = (INesMapper*)malloc(sizeof(INesMapper));
     memset(instance->mapper, 0, sizeof(INesMapper));
     instance->mapper->number = INesFileGetMapperNumber(instance->file);
@@ -33,6 +53,7 @@ INesInstance* INesInstanceCreate(const uint8_t* data, size_t size) {
         INesInstanceDestroy(instance);
         return NULL;
     }
+    INesInstanceSelectFrame(instance);
     
     instance->cpu = (CPU2A03*)malloc(sizeof(CPU2A03));
     memset(instance->cpu, 0, sizeof(CPU2A03));
@@ -73,10 +94,26 @@ void INesInstanceSetSaveRamFilePath(INesInstance* instance, const char* saveRamF
     }
     instance->file->saveRamFilePath = (char*)malloc(saveRamFilePathLength + 1);
     memcpy(instance->file->saveRamFilePath, saveRamFilePath, saveRamFilePathLength + 1);
+    // PRG RAM 通过页表直接读写，不再在第一次访问时加载
+    INesFileLoadSaveRam(instance->file);
 }
 
 void INesInstanceWrite(INesInstance* instance, uint16_t addr, uint8_t data) {
+    uint8_t* page = instance->writePages[addr >> 8];
+    if (page) {
+        page[addr & 0xff] = data;
+        if (addr < 0x2000 && instance->cpu->blockCache.RAMCodePage[addr >> 8]) {
+            CpuInvalidateRAMCode(instance->cpu);
+        }
+        return;
+    }
+    
     if (addr >= 0x4020) {
+        // 切换 CHR bank、镜像等会影响这一行之后的点
+        INesPPUCatchUp(instance);
+        if (addr < 0x6000 || addr >= 0x8000) {
+            INesPPUThreadRecord(instance, INesPPUThreadEntryMapperWrite, addr, data);
+        }
         return INesMapperWrite(instance, addr, data);
     }
     
@@ -96,7 +133,14 @@ void INesInstanceWrite(INesInstance* instance, uint16_t addr, uint8_t data) {
 }
 
 uint8_t INesInstanceRead(INesInstance* instance, uint16_t addr) {
+    const uint8_t* page = instance->readPages[addr >> 8];
+    if (page) {
+        return page[addr & 0xff];
+    }
+    
     if (addr >= 0x4020) {
+        // MMC5 等的扫描线状态由 PPU 时钟更新
+        INesPPUSync(instance);
         return INesMapperRead(instance, addr);
     }
     
@@ -137,34 +181,7 @@ uint16_t INesInstanceMappingPPUAddr(uint16_t addr) {
 }
 
 uint8_t INesInstancePPURead(INesInstance* instance, uint16_t addr) {
-    addr = INesInstanceMappingPPUAddr(addr);
-    
-    if (addr >= 0x2000 && addr < 0x3000 && INesMapperRequireMappingNametable(instance)) {
-        return INesMapperReadNameTable(instance, addr);
-    }
-    
-    if (addr < 0x2000) {
-        return INesMapperRead(instance, addr);
-    }
-    if (addr >= 0x3f00) {
-        if (addr % 4 == 0) {
-            return instance->ppu->mem[0x3f00];
-        }
-        return instance->ppu->mem[addr];
-    }
-    if (instance->mirror == INesInstanceMirrorVertical) {
-        if (addr >= 0x2800) {
-            addr -= 0x800;
-        }
-    } else if (instance->mirror == INesInstanceMirrorHorizontal) {
-        if (addr >= 0x2400 && addr < 0x2c00) {
-            addr -= 0x0400;
-        } else if (addr >= 0x2c00) {
-            addr -= 0x0800;
-        }
-    }
-    
-    return instance->ppu->mem[addr];
+    return INesInstancePPUReadMapper<INesMapperTraitsDynamic>(instance, addr);
 }
 
 void INesInstancePPUWrite(INesInstance* instance, uint16_t addr, uint8_t data) {
@@ -181,8 +198,11 @@ void INesInstancePPUWrite(INesInstance* instance, uint16_t addr, uint8_t data) {
     if (addr >= 0x3f00) {
         if (addr % 4 == 0 && (addr == 0x3f00 || addr == 0x3f10)) {
             instance->ppu->mem[0x3f00] = data;
-            return ;
+        } else {
+            instance->ppu->mem[addr] = data;
         }
+        INesPPUUpdatePalette(instance);
+        return ;
     } else {
         if (instance->mirror != INesInstanceMirrorFour) {
             if (instance->mirror == INesInstanceMirrorVertical) {
@@ -206,10 +226,17 @@ void INesInstanceTickCPU(INesInstance* instance) {
 }
 
 void INesInstanceDestroy(INesInstance* instance) {
+    // 影子实例与这里共用 PRG ROM 等，先停止后台线程
+    INesPPUThreadStop(instance);
     if (instance->file) {
         INesFileDestroy(instance->file);
     }
     if (instance->cpu) {
+        CpuJitDestroy(instance->cpu);
+        CpuTraceStop(instance->cpu);
+        CpuProfileStop(instance->cpu);
+        CpuStatsStop(instance->cpu);
+        CpuSetBlockCache(instance->cpu, false);
         free(instance->cpu);
     }
     if (instance->ppu) {
@@ -224,27 +251,298 @@ void INesInstanceDestroy(INesInstance* instance) {
     if (instance->mapper) {
         INesMapperDestroy(instance);
     }
+    INesTileCacheDestroy(instance);
+    INesPPUFramebufferDestroy(instance);
     free(instance);
 }
 
-void INesInstanceFrame(INesInstance* instance) {
-    size_t count = 0;
-    for (size_t i = 0; i < 89342; ++i) {
-        INesPPUTick(instance);
-        if (instance->ppu->tick % 3 == 0) {
-            INesInstanceTickCPU(instance);
-            if (instance->cpu->tick % 2 == 0) {
+// 返回 true 表示一帧结束
+static bool INesInstanceEndDot(INesInstance* instance) {
+    ++instance->frameDot;
+    if (instance->frameDot % 22335 == 0) {
+        INesAPUFrame(instance);
+    }
+    if (instance->frameDot == 89342) {
+        instance->frameDot = 0;
+        return true;
+    }
+    return false;
+}
+
+template <typename Mapper>
+static bool INesInstanceTickDot(INesInstance* instance) {
+    if (INesPPUAddDots(instance->ppu, 1)) {
+        INesPPURunMapper<Mapper>(instance);
+    }
+    if (instance->ppu->tick % 3 == 0) {
+        INesInstanceTickCPU(instance);
+        if (instance->cpu->tick % 2 == 0) {
+            INesAPUTick(instance->apu);
+        }
+    }
+    return INesInstanceEndDot(instance);
+}
+
+// 一个 CPU 时钟之前的 3 个 PPU 时钟。PPU 推迟到 CPU 访问它或者到达 deadline 时才执行，见 INesPPUAddDots
+template <typename Mapper>
+static void INesInstanceBeginCycle(INesInstance* instance, bool* frameEnd) {
+    if (INesPPUAddDots(instance->ppu, 3)) {
+        INesPPURunMapper<Mapper>(instance);
+    }
+    *frameEnd |= INesInstanceEndDot(instance);
+    *frameEnd |= INesInstanceEndDot(instance);
+    ++instance->cpu->tick;
+}
+
+static void INesInstanceEndCycle(INesInstance* instance, bool* frameEnd) {
+    if (instance->cpu->tick % 2 == 0) {
+        INesAPUTick(instance->apu);
+    }
+    *frameEnd |= INesInstanceEndDot(instance);
+}
+
+// 从指令的第 clock 个时钟继续执行完一条指令（或一次 NMI/IRQ），每个 CPU 时钟推进 3 个 PPU 时钟
+template <typename Mapper>
+static bool INesInstanceRunInstruction(INesInstance* instance, uint8_t clock, uint8_t cycles, bool frameEnd) {
+    CPU2A03* cpu = instance->cpu;
+    bool done = false;
+    while (!done) {
+        INesInstanceBeginCycle<Mapper>(instance, &frameEnd);
+        if (cpu->extraCycle > 0) {
+            // DMA 等偷取的时钟可能发生在指令中途，与 CpuTick 一样先消耗掉
+            --cpu->extraCycle;
+        } else {
+            if (clock == 0) {
+                cycles = CpuBeginInstruction(cpu, instance);
+            }
+            if (++clock == cycles) {
+                CpuEndInstruction(cpu, instance);
+                done = true;
+            }
+            ++cpu->totalClockCount;
+        }
+        INesInstanceEndCycle(instance, &frameEnd);
+    }
+    return frameEnd;
+}
+
+// CPU 在空转循环中时只推进 PPU/APU 而不执行指令。每条指令开始时检查 NMI/IRQ，读取 PPUSTATUS 的时钟检查其是否变化，
+// 一旦会改变循环的结果就从这条指令恢复执行，时序与逐条执行一致。
+template <typename Mapper>
+static bool INesInstanceSkipIdleLoop(INesInstance* instance, const CPUIdleLoop* loop) {
+    CPU2A03* cpu = instance->cpu;
+    bool frameEnd = false;
+    uint8_t index = 0;
+    uint8_t clock = 0;
+    while (true) {
+        INesInstanceBeginCycle<Mapper>(instance, &frameEnd);
+        if (cpu->extraCycle > 0) {
+            --cpu->extraCycle;
+            INesInstanceEndCycle(instance, &frameEnd);
+            continue;
+        }
+        if (clock == 0 && (cpu->nmi || cpu->irq)) {
+            cpu->pc = loop->instructions[index].pc;
+            uint8_t cycles = CpuBeginInstruction(cpu, instance);
+            ++cpu->totalClockCount;
+            INesInstanceEndCycle(instance, &frameEnd);
+            return INesInstanceRunInstruction<Mapper>(instance, 1, cycles, frameEnd);
+        }
+        ++cpu->totalClockCount;
+        if (++clock < loop->cycles[index]) {
+            INesInstanceEndCycle(instance, &frameEnd);
+            continue;
+        }
+        
+        if (loop->readStatus[index] && INesPPUPeekStatus(instance) != loop->status) {
+            CpuResumeIdleInstruction(cpu, instance, loop, index);
+            CpuEndInstruction(cpu, instance);
+            INesInstanceEndCycle(instance, &frameEnd);
+            return frameEnd;
+        }
+        CpuSkipIdleInstruction(cpu, loop, index);
+        INesInstanceEndCycle(instance, &frameEnd);
+        if (frameEnd) {
+            return true;
+        }
+        index = (index + 1) % loop->count;
+        clock = 0;
+    }
+}
+
+template <typename Mapper>
+static bool INesInstanceStepInstruction(INesInstance* instance) {
+    if (INesInstanceRunInstruction<Mapper>(instance, 0, 0, false)) {
+        return true;
+    }
+    CPUIdleLoop loop;
+    if (CpuDetectIdleLoop(instance->cpu, instance, &loop)) {
+        return INesInstanceSkipIdleLoop<Mapper>(instance, &loop);
+    }
+    return false;
+}
+
+// 编译的代码一次最多执行多少个时钟：指令开始时检查 NMI/IRQ 之前，PPU 不会到达 deadline、APU 不会产生帧中断，
+// 指令开始之前一帧没有结束，指令结束之前 DMC 不会偷取时钟。这些都不发生时 CPU 执行的顺序与 PPU/APU 无关。
+static uint32_t INesInstanceJitBudget(INesInstance* instance) {
+    CPU2A03* cpu = instance->cpu;
+    if (cpu->nmi || cpu->irq) {
+        return 0;
+    }
+    // 第 c 个时钟开始的指令在 c + 1 个时钟的 3 个点之后检查中断
+    const INesPPU* ppu = instance->ppu;
+    if (ppu->pendingDots + 3 >= ppu->deadline) {
+        return 0;
+    }
+    uint32_t budget = (ppu->deadline - ppu->pendingDots - 1) / 3;
+    uint32_t APUDots = (uint32_t)(22335 - instance->frameDot % 22335);
+    if ((APUDots - 1) / 3 < budget) {
+        budget = (APUDots - 1) / 3;
+    }
+    uint32_t frameDots = (uint32_t)(89342 - instance->frameDot);
+    if ((frameDots + 2) / 3 < budget) {
+        budget = (frameDots + 2) / 3;
+    }
+    // 一条指令最多 7 个时钟，最后一条指令在 DMC 偷取的时钟之前结束
+    uint32_t DMCDeadline = INesAPUGetDMCDeadline(instance->apu);
+    if (DMCDeadline <= 6) {
+        return 0;
+    }
+    if (DMCDeadline - 6 < budget) {
+        budget = DMCDeadline - 6;
+    }
+    return budget;
+}
+
+// 编译的代码执行了 cycles 个时钟之后推进 PPU/APU，INesInstanceJitBudget 保证期间 CPU 不会观察到它们
+template <typename Mapper>
+static bool INesInstanceAdvanceCycles(INesInstance* instance, uint32_t cycles) {
+    CPU2A03* cpu = instance->cpu;
+    if (INesPPUAddDots(instance->ppu, cycles * 3)) {
+        INesPPURunMapper<Mapper>(instance);
+    }
+    size_t dots = (size_t)cycles * 3;
+    if (instance->frameDot % 22335 + dots < 22335 && instance->frameDot + dots < 89342) {
+        instance->frameDot += dots;
+        for (uint32_t i = 0; i < cycles; ++i) {
+            if (++cpu->tick % 2 == 0) {
                 INesAPUTick(instance->apu);
             }
         }
-        ++count;
-        if (count == 22335) {
-            count = 0;
-            INesAPUFrame(instance);
+        return false;
+    }
+    // 最后一条指令中 APU 帧计数器到达边界或一帧结束，逐个时钟推进
+    bool frameEnd = false;
+    for (uint32_t i = 0; i < cycles; ++i) {
+        frameEnd |= INesInstanceEndDot(instance);
+        frameEnd |= INesInstanceEndDot(instance);
+        ++cpu->tick;
+        INesInstanceEndCycle(instance, &frameEnd);
+    }
+    return frameEnd;
+}
+
+// PRG ROM 中编译过的代码段先整段执行，再把 PPU/APU 推进相同的时钟，时序与逐条执行一致。
+// 没有编译的代码、时钟不够执行一条指令或者访问的页没有映射时逐条解释执行。
+template <typename Mapper>
+static bool INesInstanceStepJIT(INesInstance* instance) {
+    CPU2A03* cpu = instance->cpu;
+    const CPUJitBlock* block = CpuJitLookup(cpu, instance, cpu->pc);
+    uint32_t budget = block ? INesInstanceJitBudget(instance) : 0;
+    uint32_t cycles = budget ? CpuJitRun(cpu, instance, block, budget) : 0;
+    if (cycles == 0) {
+        return INesInstanceStepInstruction<Mapper>(instance);
+    }
+    return INesInstanceAdvanceCycles<Mapper>(instance, cycles);
+}
+
+void INesInstanceSetCPUMode(INesInstance* instance, enum INesInstanceCPUMode mode) {
+    if (mode == INesInstanceCPUModeJIT && !CpuJitEnable(instance->cpu, instance)) {
+        // 不支持 JIT 且没有 AOT 代码时使用指令级模式
+        mode = INesInstanceCPUModeInstruction;
+    }
+    // 逐时钟模式每条指令只解码一次，不需要 block 缓存
+    CpuSetBlockCache(instance->cpu, mode != INesInstanceCPUModeCycle);
+    instance->cpuMode = mode;
+}
+
+void INesInstanceSetRenderSkip(INesInstance* instance, bool skip) {
+    instance->renderSkip = skip;
+}
+
+bool INesInstanceSetRenderThread(INesInstance* instance, bool enable) {
+    if (!enable) {
+        INesPPUThreadStop(instance);
+        return false;
+    }
+    return INesPPUThreadStart(instance);
+}
+
+template <typename Mapper>
+static void INesInstanceRunFrame(INesInstance* instance) {
+    if (instance->cpuMode != INesInstanceCPUModeCycle) {
+        // 先逐时钟推进到指令边界
+        while (instance->ppu->tick % 3 != 0 || !CpuAtInstructionBoundary(instance->cpu)) {
+            if (INesInstanceTickDot<Mapper>(instance)) {
+                return;
+            }
         }
+        if (instance->cpuMode == INesInstanceCPUModeJIT) {
+            while (!INesInstanceStepJIT<Mapper>(instance)) {
+            }
+        } else {
+            while (!INesInstanceStepInstruction<Mapper>(instance)) {
+            }
+        }
+        return;
+    }
+    
+    while (!INesInstanceTickDot<Mapper>(instance)) {
+    }
+}
+
+template <typename Mapper>
+static void INesInstanceFrameMapper(INesInstance* instance) {
+    INesPPUThreadBeginFrame(instance);
+    INesInstanceRunFrame<Mapper>(instance);
+    // 执行完推迟的点，返回后调用方读取的 output 和输出帧是完整的
+    INesPPURunMapper<Mapper>(instance);
+    INesPPUThreadEndFrame(instance);
+}
+
+static void INesInstanceSelectFrame(INesInstance* instance) {
+    switch ((INesMapperType)instance->mapper->number) {
+        case INesMapperTypeNROM:
+            instance->frame = INesInstanceFrameMapper<INesMapperTraitsNROM>;
+            instance->catchUp = INesPPUCatchUpMapper<INesMapperTraitsNROM>;
+            break;
+        case INesMapperTypeMMC1:
+            instance->frame = INesInstanceFrameMapper<INesMapperTraitsMMC1>;
+            instance->catchUp = INesPPUCatchUpMapper<INesMapperTraitsMMC1>;
+            break;
+        case INesMapperTypeUxROM:
+            instance->frame = INesInstanceFrameMapper<INesMapperTraitsUxROM>;
+            instance->catchUp = INesPPUCatchUpMapper<INesMapperTraitsUxROM>;
+            break;
+        case INesMapperTypeCNROM:
+            instance->frame = INesInstanceFrameMapper<INesMapperTraitsCNROM>;
+            instance->catchUp = INesPPUCatchUpMapper<INesMapperTraitsCNROM>;
+            break;
+        case INesMapperTypeMMC3:
+            instance->frame = INesInstanceFrameMapper<INesMapperTraitsMMC3>;
+            instance->catchUp = INesPPUCatchUpMapper<INesMapperTraitsMMC3>;
+            break;
+        default:
+            instance->frame = INesInstanceFrameMapper<INesMapperTraitsDynamic>;
+            instance->catchUp = INesPPUCatchUpMapper<INesMapperTraitsDynamic>;
+            break;
     }
 }
 
+void INesInstanceFrame(INesInstance* instance) {
+    instance->frame(instance);
+}
+
 void INesInstanceOnPPUTick(INesInstance* instance) {
     INesMapperPPUTick(instance);
 }
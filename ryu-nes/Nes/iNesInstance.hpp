@@ -25,11 +25,20 @@ enum INesInstanceMirror {
     INesInstanceMirrorFour = 3
 };
 
+enum INesInstanceCPUMode {
+    INesInstanceCPUModeCycle = 0,           // 每个 CPU 时钟调用一次 CpuTick
+    INesInstanceCPUModeInstruction = 1,     // 每次执行一整条指令，PPU/APU 按指令消耗的时钟追赶
+    INesInstanceCPUModeJIT = 2              // 同指令级模式，PRG ROM 中的代码使用 AOT 或 JIT 编译的机器码整段执行
+};
+
 struct CPU2A03;
 struct INesPPU;
 struct INesPad;
 struct INesAPU;
 struct INesMapper;
+struct INesTileCache;
+struct INesPPUFramebuffer;
+struct INesPPUThread;
 
 struct INesInstance {
     INesFile* file;
@@ -39,7 +48,18 @@ struct INesInstance {
     INesPad* pad;
     INesAPU* apu;
     INesMapper* mapper;
+    INesTileCache* tileCache;
+    INesPPUFramebuffer* framebuffer;    // 见 INesPPUSetFramebuffer，为 NULL 时只输出颜色索引
     enum INesInstanceMirror mirror;
+    enum INesInstanceCPUMode cpuMode;
+    bool renderSkip;        // 见 INesInstanceSetRenderSkip
+    INesPPUThread* renderThread;        // 见 INesInstanceSetRenderThread，为 NULL 时在 CPU 线程中渲染
+    size_t frameDot;
+    void (*frame)(INesInstance* instance);      // 按 mapper 实例化的主循环，在 INesInstanceCreate 中选择
+    void (*catchUp)(INesInstance* instance, bool write);    // 按 mapper 实例化的 INesPPUCatchUp/INesPPUSync，与 frame 一起选择
+    // CPU 地址空间每 256 字节一页：内部 RAM、PRG ROM 和 PRG RAM 直接读写，为 NULL 的页（I/O 寄存器等）按地址分发
+    uint8_t* readPages[0x100];
+    uint8_t* writePages[0x100];
 };
 
 INesInstance* INesInstanceCreate(const uint8_t* data, size_t size);
@@ -53,6 +73,13 @@ uint16_t INesInstanceMappingPPUAddr(uint16_t addr);
 uint8_t INesInstancePPURead(INesInstance* instance, uint16_t addr);
 void INesInstancePPUWrite(INesInstance* instance, uint16_t addr, uint8_t data);
 void INesInstanceTickCPU(INesInstance* instance);
+// 指令级和 JIT 模式的画面和 CPU 时钟与逐时钟模式相同，但一帧在指令边界结束：跨越帧边界的指令整条执行完才返回，
+// 所以每帧结束时的 RAM 和 PPU 状态（如精灵溢出、0 号精灵命中标志）可能与逐时钟模式不同
+void INesInstanceSetCPUMode(INesInstance* instance, enum INesInstanceCPUMode mode);
+// 为 true 时从下一帧（预渲染扫描线）开始不生成像素，只保留 sprite 0 hit、精灵溢出、v/t 和 IRQ 等程序能观察到的结果
+void INesInstanceSetRenderSkip(INesInstance* instance, bool skip);
+// 为 true 时从下一帧开始由后台线程渲染，INesInstanceFrame 返回时 ppu->output 和输出帧是上一帧的结果，输出帧见 INesPPUThreadStart。返回是否已经开启
+bool INesInstanceSetRenderThread(INesInstance* instance, bool enable);
 void INesInstanceDestroy(INesInstance* instance);
 void INesInstanceFrame(INesInstance* instance);
 void INesInstanceOnPPUTick(INesInstance* instance);
@@ -6,10 +6,12 @@
 #include "iNesMapper004.hpp"
 #include "iNesMapper005.hpp"
 #include "iNesMapper074.hpp"
+#include "iNesTileCache.hpp"
 #include <string.h>
 #include <assert.h>
 
-static void (*INesMapperWriteFuncs[256])(INesInstance* instance, uint16_t addr, uint8_t data) = {
+// 返回 true 表示 bank 映射或镜像发生了变化
+static bool (*INesMapperWriteFuncs[256])(INesInstance* instance, uint16_t addr, uint8_t data) = {
     INesMapper000Write,
     INesMapper001Write,
     INesMapper002Write,
@@ -36,20 +38,62 @@ static bool (*INesMapperInitFuncs[256])(INesInstance* instance) = {
     INesMapper005Init,
 };
 
+static int32_t (*INesMapperPRGOffsetFuncs[256])(INesInstance* instance, uint16_t addr) = {
+    INesMapper000PRGOffset,
+    INesMapper001PRGOffset,
+    INesMapper002PRGOffset,
+    INesMapper003PRGOffset,
+    INesMapper004PRGOffset,
+    INesMapper005PRGOffset,
+};
+
+// MMC5 的 CHR 映射取决于正在读取背景还是精灵，不能按页直接映射
+static int32_t (*INesMapperCHROffsetFuncs[256])(INesInstance* instance, uint16_t addr) = {
+    INesMapper000CHROffset,
+    INesMapper001CHROffset,
+    INesMapper002CHROffset,
+    INesMapper003CHROffset,
+    INesMapper004CHROffset,
+    NULL,
+};
+
+static int32_t (*INesMapperPRGRAMOffsetFuncs[256])(INesInstance* instance, uint16_t addr) = {
+    NULL,
+    INesMapper001PRGRAMOffset,
+    NULL,
+    NULL,
+    INesMapper004PRGRAMOffset,
+    INesMapper005PRGRAMOffset,
+};
+
 static void (*INesMapperPPUTickFuncs[256])(INesInstance* instance) = {
 };
 
-//MARK: interface
-bool INesMapperInit(INesInstance* instance) {
+// 不能按顺序初始化的表项，只在第一次创建实例时注册一次（局部静态变量的初始化是线程安全的）
+static bool INesMapperRegisterFuncs() {
     INesMapperPPUTickFuncs[INesMapperTypeMMC3] = INesMapper004PPUTick;
     INesMapperInitFuncs[INesMapperType074] = INesMapper074Init;
     INesMapperReadFuncs[INesMapperType074] = INesMapper074Read;
     INesMapperWriteFuncs[INesMapperType074] = INesMapper074Write;
+    INesMapperPRGOffsetFuncs[INesMapperType074] = INesMapper074PRGOffset;
+    INesMapperPRGRAMOffsetFuncs[INesMapperType074] = INesMapper074PRGRAMOffset;
+    INesMapperCHROffsetFuncs[INesMapperType074] = INesMapper074CHROffset;
     INesMapperPPUTickFuncs[INesMapperType074] = INesMapper074PPUTick;
     INesMapperPPUTickFuncs[INesMapperTypeMMC5] = INesMapper005PPUTick;
+    return true;
+}
+
+//MARK: interface
+bool INesMapperInit(INesInstance* instance) {
+    static const bool registered = INesMapperRegisterFuncs();
+    (void)registered;
     
     bool (*CheckFunc)(INesInstance* instance) = INesMapperInitFuncs[instance->mapper->number];
-    return CheckFunc(instance);
+    if (!CheckFunc(instance)) {
+        return false;
+    }
+    INesMapperUpdatePages(instance);
+    return true;
 }
 
 bool INesMapperRequireMappingNametable(INesInstance* instance) {
@@ -70,8 +114,15 @@ uint8_t INesMapperReadNameTable(INesInstance* instance, uint16_t addr) {
 }
 
 void INesMapperWrite(INesInstance* instance, uint16_t addr, uint8_t data) {
-    void (*WriteFunc)(INesInstance* instance, uint16_t addr, uint8_t data) = INesMapperWriteFuncs[instance->mapper->number];
-    WriteFunc(instance, addr, data);
+    bool (*WriteFunc)(INesInstance* instance, uint16_t addr, uint8_t data) = INesMapperWriteFuncs[instance->mapper->number];
+    bool changed = WriteFunc(instance, addr, data);
+    if (addr < 0x2000) {
+        INesTileCacheInvalidate(instance, addr);
+    }
+    if (changed) {
+        ++instance->mapper->PRGGeneration;
+        INesMapperUpdatePages(instance);
+    }
 }
 
 uint8_t INesMapperRead(INesInstance* instance, uint16_t addr) {
@@ -79,6 +130,54 @@ uint8_t INesMapperRead(INesInstance* instance, uint16_t addr) {
     return ReadFunc(instance, addr);
 }
 
+// 返回 addr 当前映射到的 PRG ROM 偏移，不是 PRG ROM 时返回 -1
+int32_t INesMapperGetPRGOffset(INesInstance* instance, uint16_t addr) {
+    int32_t (*PRGOffsetFunc)(INesInstance* instance, uint16_t addr) = INesMapperPRGOffsetFuncs[instance->mapper->number];
+    if (!PRGOffsetFunc) {
+        return -1;
+    }
+    return PRGOffsetFunc(instance, addr);
+}
+
+// 返回 PPU 地址 addr 当前映射到的 CHR 偏移，见 INesMapperCHRRAMOffset，不能直接映射时返回 -1
+int32_t INesMapperGetCHROffset(INesInstance* instance, uint16_t addr) {
+    int32_t (*CHROffsetFunc)(INesInstance* instance, uint16_t addr) = INesMapperCHROffsetFuncs[instance->mapper->number];
+    if (!CHROffsetFunc) {
+        return -1;
+    }
+    return CHROffsetFunc(instance, addr);
+}
+
+// CHR 偏移中 CHR RAM（ppu->mem 的 $0000-$1FFF）排在 CHR ROM 之后
+int32_t INesMapperCHRRAMOffset(INesInstance* instance, uint16_t addr) {
+    return (int32_t)instance->file->CHRRomSize + (int32_t)addr;
+}
+
+// 按当前的 bank 映射更新 $6000-$FFFF 的页表和 CHR 的 tile 缓存，PRG ROM 只读，PRG RAM 可以直接读写，其余由 mapper 的读写函数处理
+void INesMapperUpdatePages(INesInstance* instance) {
+    const INesFile* file = instance->file;
+    int32_t (*PRGOffsetFunc)(INesInstance* instance, uint16_t addr) = INesMapperPRGOffsetFuncs[instance->mapper->number];
+    int32_t (*PRGRAMOffsetFunc)(INesInstance* instance, uint16_t addr) = INesMapperPRGRAMOffsetFuncs[instance->mapper->number];
+    for (uint32_t page = 0x60; page < 0x100; ++page) {
+        uint16_t addr = (uint16_t)(page << 8);
+        instance->readPages[page] = NULL;
+        instance->writePages[page] = NULL;
+        if (page >= 0x80) {
+            int32_t offset = PRGOffsetFunc ? PRGOffsetFunc(instance, addr) : -1;
+            if (offset >= 0 && (size_t)offset + 0x100 <= file->PRGRomSize) {
+                instance->readPages[page] = file->PRGRom + offset;
+            }
+        } else {
+            int32_t offset = PRGRAMOffsetFunc ? PRGRAMOffsetFunc(instance, addr) : -1;
+            if (offset >= 0 && (size_t)offset + 0x100 <= file->PRGRamSize) {
+                instance->readPages[page] = file->PRGRam + offset;
+                instance->writePages[page] = file->PRGRam + offset;
+            }
+        }
+    }
+    INesTileCacheUpdatePages(instance);
+}
+
 void INesMapperPPUTick(INesInstance* instance) {
     void (*PPUTickFunc)(INesInstance* instance) = INesMapperPPUTickFuncs[instance->mapper->number];
     if (PPUTickFunc) {
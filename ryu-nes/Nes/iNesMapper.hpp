@@ -9,6 +9,8 @@ struct INesInstance;
 struct INesMapper {
     uint8_t number;
     void* data;
+    size_t dataSize;            // data 的字节数，后台渲染线程复制 mapper 状态时使用
+    uint32_t PRGGeneration;     // CPU 写 mapper 寄存器使 bank 映射变化时递增，用于判断 PRG bank 映射是否可能变化
 };
 
 enum INesMapperType {
@@ -27,6 +29,10 @@ void INesMapperWriteNameTable(INesInstance* instance, uint16_t addr, uint8_t dat
 uint8_t INesMapperReadNameTable(INesInstance* instance, uint16_t addr);
 void INesMapperWrite(INesInstance* instance, uint16_t addr, uint8_t data);
 uint8_t INesMapperRead(INesInstance* instance, uint16_t addr);
+int32_t INesMapperGetPRGOffset(INesInstance* instance, uint16_t addr);
+int32_t INesMapperGetCHROffset(INesInstance* instance, uint16_t addr);
+int32_t INesMapperCHRRAMOffset(INesInstance* instance, uint16_t addr);
+void INesMapperUpdatePages(INesInstance* instance);
 void INesMapperPPUTick(INesInstance* instance);
 void INesMapperDestroy(INesInstance* instance);
 
@@ -31,13 +31,13 @@ bool INesMapper000Init(INesInstance* instance) {
     return true;
 }
 
-void INesMapper000Write(INesInstance* instance, uint16_t addr, uint8_t data) {
+bool INesMapper000Write(INesInstance* instance, uint16_t addr, uint8_t data) {
     assert(addr >= 0x4020 || addr < 0x2000);
     assert(instance->mapper->number == (uint8_t)INesMapperTypeNROM);
     if (addr < 0x2000) {
         instance->ppu->mem[addr] = data;
     }
-    return ;
+    return false;
 }
 
 uint8_t INesMapper000Read(INesInstance* instance, uint16_t addr) {
@@ -46,12 +46,7 @@ uint8_t INesMapper000Read(INesInstance* instance, uint16_t addr) {
     
     if (addr >= 0x8000) {
         // PRG
-        if (instance->file->PRGRomSize == 16384) {
-            return instance->file->PRGRom[(addr-0x8000)%0x4000];
-        } else {
-            assert(instance->file->PRGRomSize == 32768);
-            return instance->file->PRGRom[addr-0x8000];
-        }
+        return instance->file->PRGRom[INesMapper000PRGOffset(instance, addr)];
     } else {
         assert(instance->file->CHRRomSize == 8192);
         // CHR
@@ -60,3 +55,19 @@ uint8_t INesMapper000Read(INesInstance* instance, uint16_t addr) {
 
     return 0;
 }
+
+int32_t INesMapper000PRGOffset(INesInstance* instance, uint16_t addr) {
+    if (addr < 0x8000) {
+        return -1;
+    }
+    if (instance->file->PRGRomSize == 16384) {
+        return (addr-0x8000)%0x4000;
+    } else {
+        assert(instance->file->PRGRomSize == 32768);
+        return addr-0x8000;
+    }
+}
+
+int32_t INesMapper000CHROffset(INesInstance*, uint16_t addr) {
+    return addr;
+}
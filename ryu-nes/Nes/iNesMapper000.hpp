@@ -6,7 +6,9 @@
 #include <stdio.h>
 
 bool INesMapper000Init(INesInstance* instance);
-void INesMapper000Write(INesInstance* instance, uint16_t addr, uint8_t data);
+bool INesMapper000Write(INesInstance* instance, uint16_t addr, uint8_t data);
 uint8_t INesMapper000Read(INesInstance* instance, uint16_t addr);
+int32_t INesMapper000PRGOffset(INesInstance* instance, uint16_t addr);
+int32_t INesMapper000CHROffset(INesInstance* instance, uint16_t addr);
 
 #endif /* iNesMapper000_hpp */
@@ -39,6 +39,7 @@ bool INesMapper001Init(INesInstance* instance) {
     }
     
     instance->mapper->data = malloc(sizeof(INesMapper001));
+    instance->mapper->dataSize = sizeof(INesMapper001);
     memset(instance->mapper->data, 0, sizeof(INesMapper001));
     INesMapper001* mapper001 = (INesMapper001*)instance->mapper->data;
     mapper001->loadRegister = 0x10;
@@ -58,7 +59,7 @@ bool INesMapper001Init(INesInstance* instance) {
     return true;
 }
 
-void INesMapper001Write(INesInstance* instance, uint16_t addr, uint8_t data) {
+bool INesMapper001Write(INesInstance* instance, uint16_t addr, uint8_t data) {
     assert(addr >= 0x4020 || addr < 0x2000);
     assert(instance->mapper->number == (uint8_t)INesMapperTypeMMC1);
     INesMapper001* mapper001 = (INesMapper001*)instance->mapper->data;
@@ -68,6 +69,7 @@ void INesMapper001Write(INesInstance* instance, uint16_t addr, uint8_t data) {
             mapper001->loadRegister = 0x10;
             mapper001->controlRegister = 0x0c;
             mapper001->mode4kb = (mapper001->controlRegister >> 4) & 1;
+            return true;
         } else {
             uint8_t complete = mapper001->loadRegister & 1;
             mapper001->loadRegister >>= 1;
@@ -106,6 +108,7 @@ void INesMapper001Write(INesInstance* instance, uint16_t addr, uint8_t data) {
                     mapper001->prgBank = mapper001->loadRegister & 0x0f;
                 }
                 mapper001->loadRegister = 0x10;
+                return true;
             }
         }
     } else if (addr >= 0x6000) {
@@ -116,6 +119,7 @@ void INesMapper001Write(INesInstance* instance, uint16_t addr, uint8_t data) {
         // CHR
         instance->ppu->mem[addr] = data;
     }
+    return false;
 }
 
 uint8_t INesMapper001Read(INesInstance* instance, uint16_t addr) {
@@ -123,42 +127,11 @@ uint8_t INesMapper001Read(INesInstance* instance, uint16_t addr) {
     INesMapper001* mapper001 = (INesMapper001*)instance->mapper->data;
     
     if (addr >= 0x8000) {
-        size_t startOffset = 0;
-        size_t spaceSize = instance->file->PRGRomSize;
-        uint32_t pbank = mapper001->prgBank;
-        size_t prgAddr = 0;
-        
-        if (mapper001->type == INesMapper001TypeSOSUSX) {
-            if (mapper001->PRG256ROMBank) {
-                startOffset = 262144;
-            }
-            spaceSize = 262144;
-        }
-        uint8_t prgBankMode = (mapper001->controlRegister >> 2) & 3;
-        if (prgBankMode <= 1) {
-            return instance->file->PRGRom[startOffset + ((pbank & 0xe) << 14) + (uint32_t)(addr - 0x8000)];
-        } else if (prgBankMode == 2) {
-            if (addr < 0xc000) {
-                // fix first bank at $8000
-                return instance->file->PRGRom[startOffset + addr - 0x8000];
-            } else {
-                assert(addr >= 0xc000);
-                return instance->file->PRGRom[startOffset + (pbank << 14) + (uint32_t)(addr - 0xc000)];
-            }
-        } else if (prgBankMode == 3) {
-            if (addr >= 0xc000) {
-                // fix last bank at $C000
-                prgAddr = startOffset + spaceSize - 0x4000 + ((uint32_t)addr - 0xc000);
-                if (prgAddr >= instance->file->PRGRomSize) {
-                    assert(!"prg size error!");
-                    return 0;
-                }
-                return instance->file->PRGRom[prgAddr];
-            } else {
-                assert(addr < 0xc000);
-                return instance->file->PRGRom[startOffset + (pbank << 14) + (uint32_t)(addr - 0x8000)];
-            }
+        int32_t prgAddr = INesMapper001PRGOffset(instance, addr);
+        if (prgAddr < 0) {
+            return 0;
         }
+        return instance->file->PRGRom[prgAddr];
     } else if (addr >= 0x6000) {
         uint16_t offset = addr - 0x6000;
         uint16_t bankSize = mapper001->mode4kb ? KB4 : KB8;
@@ -199,3 +172,78 @@ uint8_t INesMapper001Read(INesInstance* instance, uint16_t addr) {
     }
     return 0;
 }
+
+int32_t INesMapper001PRGRAMOffset(INesInstance* instance, uint16_t addr) {
+    if (addr < 0x6000 || addr >= 0x8000) {
+        return -1;
+    }
+    INesMapper001* mapper001 = (INesMapper001*)instance->mapper->data;
+    uint16_t bankSize = mapper001->mode4kb ? KB4 : KB8;
+    return (int32_t)(addr - 0x6000 + bankSize * mapper001->PRGRAMBank);
+}
+
+int32_t INesMapper001PRGOffset(INesInstance* instance, uint16_t addr) {
+    if (addr < 0x8000) {
+        return -1;
+    }
+    
+    INesMapper001* mapper001 = (INesMapper001*)instance->mapper->data;
+    size_t startOffset = 0;
+    size_t spaceSize = instance->file->PRGRomSize;
+    uint32_t pbank = mapper001->prgBank;
+    size_t prgAddr = 0;
+    
+    if (mapper001->type == INesMapper001TypeSOSUSX) {
+        if (mapper001->PRG256ROMBank) {
+            startOffset = 262144;
+        }
+        spaceSize = 262144;
+    }
+    uint8_t prgBankMode = (mapper001->controlRegister >> 2) & 3;
+    if (prgBankMode <= 1) {
+        return (int32_t)(startOffset + ((pbank & 0xe) << 14) + (uint32_t)(addr - 0x8000));
+    } else if (prgBankMode == 2) {
+        if (addr < 0xc000) {
+            // fix first bank at $8000
+            return (int32_t)(startOffset + addr - 0x8000);
+        } else {
+            assert(addr >= 0xc000);
+            return (int32_t)(startOffset + (pbank << 14) + (uint32_t)(addr - 0xc000));
+        }
+    } else {
+        assert(prgBankMode == 3);
+        if (addr >= 0xc000) {
+            // fix last bank at $C000
+            prgAddr = startOffset + spaceSize - 0x4000 + ((uint32_t)addr - 0xc000);
+            if (prgAddr >= instance->file->PRGRomSize) {
+                assert(!"prg size error!");
+                return -1;
+            }
+            return (int32_t)prgAddr;
+        } else {
+            assert(addr < 0xc000);
+            return (int32_t)(startOffset + (pbank << 14) + (uint32_t)(addr - 0x8000));
+        }
+    }
+}
+
+int32_t INesMapper001CHROffset(INesInstance* instance, uint16_t addr) {
+    INesMapper001* mapper001 = (INesMapper001*)instance->mapper->data;
+    if (instance->file->onlyCHRRam) {
+        return INesMapperCHRRAMOffset(instance, addr);
+    }
+    uint32_t cvtaddr = 0;
+    if (mapper001->mode4kb) {
+        if (addr < 0x1000) {
+            cvtaddr = ((uint32_t)mapper001->chrBank0 << 12) + (uint32_t)addr;
+        } else {
+            cvtaddr = ((uint32_t)mapper001->chrBank1 << 12) + ((uint32_t)addr - (uint32_t)0x1000);
+        }
+    } else {
+        cvtaddr = ((uint32_t)(mapper001->chrBank0 & 0xfe) << 12) + (uint32_t)addr;
+    }
+    if (cvtaddr >= instance->file->CHRRomSize) {
+        return -1;
+    }
+    return (int32_t)cvtaddr;
+}
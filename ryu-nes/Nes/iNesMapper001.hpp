@@ -6,7 +6,10 @@
 
 
 bool INesMapper001Init(INesInstance* instance);
-void INesMapper001Write(INesInstance* instance, uint16_t addr, uint8_t data);
+bool INesMapper001Write(INesInstance* instance, uint16_t addr, uint8_t data);
 uint8_t INesMapper001Read(INesInstance* instance, uint16_t addr);
+int32_t INesMapper001PRGOffset(INesInstance* instance, uint16_t addr);
+int32_t INesMapper001CHROffset(INesInstance* instance, uint16_t addr);
+int32_t INesMapper001PRGRAMOffset(INesInstance* instance, uint16_t addr);
 
 #endif
@@ -23,35 +23,34 @@ bool INesMapper002Init(INesInstance* instance) {
     }
     
     instance->mapper->data = malloc(sizeof(INesMapper002));
+    instance->mapper->dataSize = sizeof(INesMapper002);
     memset(instance->mapper->data, 0, sizeof(INesMapper002));
     
     return true;
 }
 
-void INesMapper002Write(INesInstance* instance, uint16_t addr, uint8_t data) {
+bool INesMapper002Write(INesInstance* instance, uint16_t addr, uint8_t data) {
     assert(addr >= 0x4020 || addr < 0x2000);
     assert(instance->mapper->number == (uint8_t)INesMapperTypeUxROM);
     INesMapper002* mapper002 = (INesMapper002*)instance->mapper->data;
     
     if (addr >= 0x8000) {
+        bool changed = mapper002->bankSelectRegister != data;
         mapper002->bankSelectRegister = data;
+        return changed;
     } else if (addr < 0x2000){
         instance->ppu->mem[addr] = data;
     }
+    return false;
 }
 
 uint8_t INesMapper002Read(INesInstance* instance, uint16_t addr) {
     assert(addr >= 0x4020 || addr < 0x2000);
     assert(instance->mapper->number == (uint8_t)INesMapperTypeUxROM);
     assert(instance->file->PRGRomSize >= 0x4000);
-    INesMapper002* mapper002 = (INesMapper002*)instance->mapper->data;
     
     if (addr >= 0x8000) {
-        if (addr >= 0xc000) {
-            return instance->file->PRGRom[instance->file->PRGRomSize - 0x4000 + (uint32_t)addr - 0xc000];
-        } else {
-            return instance->file->PRGRom[(((uint32_t)mapper002->bankSelectRegister & 0xf) << 14) + (uint32_t)addr - 0x8000];
-        }
+        return instance->file->PRGRom[INesMapper002PRGOffset(instance, addr)];
     } else if (addr < 0x2000) {
         // CHR
         return instance->ppu->mem[addr];
@@ -59,3 +58,19 @@ uint8_t INesMapper002Read(INesInstance* instance, uint16_t addr) {
     
     return 0;
 }
+
+int32_t INesMapper002PRGOffset(INesInstance* instance, uint16_t addr) {
+    INesMapper002* mapper002 = (INesMapper002*)instance->mapper->data;
+    if (addr < 0x8000) {
+        return -1;
+    }
+    if (addr >= 0xc000) {
+        return (int32_t)(instance->file->PRGRomSize - 0x4000 + (uint32_t)addr - 0xc000);
+    } else {
+        return (int32_t)((((uint32_t)mapper002->bankSelectRegister & 0xf) << 14) + (uint32_t)addr - 0x8000);
+    }
+}
+
+int32_t INesMapper002CHROffset(INesInstance* instance, uint16_t addr) {
+    return INesMapperCHRRAMOffset(instance, addr);
+}
@@ -6,7 +6,9 @@
 #include <stdio.h>
 
 bool INesMapper002Init(INesInstance* instance);
-void INesMapper002Write(INesInstance* instance, uint16_t addr, uint8_t data);
+bool INesMapper002Write(INesInstance* instance, uint16_t addr, uint8_t data);
 uint8_t INesMapper002Read(INesInstance* instance, uint16_t addr);
+int32_t INesMapper002PRGOffset(INesInstance* instance, uint16_t addr);
+int32_t INesMapper002CHROffset(INesInstance* instance, uint16_t addr);
 
 #endif /* iNesMapper002_hpp */
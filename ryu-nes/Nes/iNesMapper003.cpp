@@ -5,10 +5,6 @@
 #include <string.h>
 #include <assert.h>
 
-struct INesMapper003 {
-    uint8_t bankSelectRegister;
-};
-
 bool INesMapper003Init(INesInstance* instance) {
     if (instance->mapper->data) {
         free(instance->mapper->data);
@@ -28,23 +24,27 @@ bool INesMapper003Init(INesInstance* instance) {
     }
     
     instance->mapper->data = malloc(sizeof(INesMapper003));
+    instance->mapper->dataSize = sizeof(INesMapper003);
     memset(instance->mapper->data, 0, sizeof(INesMapper003));
     
     return true;
 }
 
-void INesMapper003Write(INesInstance* instance, uint16_t addr, uint8_t data) {
+bool INesMapper003Write(INesInstance* instance, uint16_t addr, uint8_t data) {
     assert(addr >= 0x4020 || addr < 0x2000);
     assert(instance->mapper->number == (uint8_t)INesMapperTypeCNROM);
     INesMapper003* mapper003 = (INesMapper003*)instance->mapper->data;
     
     if (addr >= 0x8000) {
+        bool changed = mapper003->bankSelectRegister != data;
         mapper003->bankSelectRegister = data;
+        return changed;
     } else if (addr < 0x2000) {
         if (instance->file->CHRRomSize == 0) {
             instance->ppu->mem[addr] = data;
         }
     }
+    return false;
 }
 
 uint8_t INesMapper003Read(INesInstance* instance, uint16_t addr) {
@@ -53,12 +53,7 @@ uint8_t INesMapper003Read(INesInstance* instance, uint16_t addr) {
     
     if (addr >= 0x8000) {
         // PRG
-        if (instance->file->PRGRomSize == 16384) {
-            return instance->file->PRGRom[(addr-0x8000)%0x4000];
-        } else {
-            assert(instance->file->PRGRomSize == 32768);
-            return instance->file->PRGRom[addr-0x8000];
-        }
+        return instance->file->PRGRom[INesMapper003PRGOffset(instance, addr)];
     } else if (addr < 0x2000) {
         // CHR
         if (instance->file->CHRRomSize == 0) {
@@ -74,3 +69,27 @@ uint8_t INesMapper003Read(INesInstance* instance, uint16_t addr) {
     }
     return 0;
 }
+
+int32_t INesMapper003PRGOffset(INesInstance* instance, uint16_t addr) {
+    if (addr < 0x8000) {
+        return -1;
+    }
+    if (instance->file->PRGRomSize == 16384) {
+        return (addr-0x8000)%0x4000;
+    } else {
+        assert(instance->file->PRGRomSize == 32768);
+        return addr-0x8000;
+    }
+}
+
+int32_t INesMapper003CHROffset(INesInstance* instance, uint16_t addr) {
+    INesMapper003* mapper003 = (INesMapper003*)instance->mapper->data;
+    if (instance->file->CHRRomSize == 0) {
+        return INesMapperCHRRAMOffset(instance, addr);
+    }
+    uint32_t cvtaddr = (((uint32_t)mapper003->bankSelectRegister & 3) << 13) + (uint32_t)addr;
+    if (cvtaddr >= instance->file->CHRRomSize) {
+        return -1;
+    }
+    return (int32_t)cvtaddr;
+}
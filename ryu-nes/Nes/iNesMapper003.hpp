@@ -5,8 +5,14 @@
 
 #include <stdio.h>
 
+struct INesMapper003 {
+    uint8_t bankSelectRegister;
+};
+
 bool INesMapper003Init(INesInstance* instance);
-void INesMapper003Write(INesInstance* instance, uint16_t addr, uint8_t data);
+bool INesMapper003Write(INesInstance* instance, uint16_t addr, uint8_t data);
 uint8_t INesMapper003Read(INesInstance* instance, uint16_t addr);
+int32_t INesMapper003PRGOffset(INesInstance* instance, uint16_t addr);
+int32_t INesMapper003CHROffset(INesInstance* instance, uint16_t addr);
 
 #endif /* iNesMapper003_hpp */
@@ -36,7 +36,7 @@ static uint32_t switchPRGBankAddr(INesMapper004* mapper004, uint8_t R, uint32_t
 }
 
 
-static uint32_t INesMapper004MappingCHRAddr(INesInstance* instance, uint16_t addr) {
+static uint32_t INesMapper004SwitchCHRAddr(INesInstance* instance, uint16_t addr) {
     assert(addr < 0x2000);
     INesMapper004* mapper004 = (INesMapper004*)instance->mapper->data;
     uint32_t cvt = 0;
@@ -111,6 +111,11 @@ static uint32_t INesMapper004MappingCHRAddr(INesInstance* instance, uint16_t add
     }
     
     cvt = switchCHRBankAddr(mapper004, R, addr, B);
+    return cvt;
+}
+
+static uint32_t INesMapper004MappingCHRAddr(INesInstance* instance, uint16_t addr) {
+    uint32_t cvt = INesMapper004SwitchCHRAddr(instance, addr);
     
     if (cvt >= instance->file->CHRRomSize) {
         return 0;
@@ -135,41 +140,12 @@ static void INesMapper004CHRWrite(INesInstance* instance, uint16_t addr, uint8_t
 static uint8_t INesMapper004PRGRead(INesInstance* instance, uint16_t addr) {
     assert(addr >= 0x8000);
     
-    INesMapper004* mapper004 = (INesMapper004*)instance->mapper->data;
-    uint32_t cvt = 0;
-    uint8_t R = 0;
-    uint32_t B = 0;
-    
-    if (addr >= 0xe000) {
-        // last bank
-        return INesFileReadRom(instance->file, instance->file->PRGRomSize - 0x2000 + addr - 0xe000);
-    } else if (addr >= 0xc000) {
-        if (mapper004->PRGROMBankMode) {
-            R = 6;
-            B = 0xc000;
-        } else {
-            // penultimate
-            return instance->file->PRGRom[instance->file->PRGRomSize - 0x4000 + addr - 0xc000];
-        }
-    } else if (addr >= 0xa000) {
-        R = 7;
-        B = 0xa000;
-    } else {
-        assert(addr >= 0x8000);
-        if (mapper004->PRGROMBankMode) {
-            // penultimate
-            return instance->file->PRGRom[instance->file->PRGRomSize - 0x4000 + addr - 0x8000];
-        } else {
-            R = 6;
-            B = 0x8000;
-        }
-    }
-    cvt = switchPRGBankAddr(mapper004, R, addr, B);
-    if (cvt >= instance->file->PRGRomSize) {
+    int32_t cvt = INesMapper004PRGOffset(instance, addr);
+    if (cvt < 0) {
         return 0;
     }
     
-    return instance->file->PRGRom[cvt];
+    return INesFileReadRom(instance->file, cvt);
 }
 
 bool INesMapper004Init(INesInstance* instance) {
@@ -191,13 +167,14 @@ bool INesMapper004Init(INesInstance* instance) {
     }
     
     instance->mapper->data = malloc(sizeof(INesMapper004));
+    instance->mapper->dataSize = sizeof(INesMapper004);
     memset(instance->mapper->data, 0, sizeof(INesMapper004));
     ((INesMapper004*)instance->mapper->data)->instance = instance;
     
     return true;
 }
 
-void INesMapper004Write(INesInstance* instance, uint16_t addr, uint8_t data) {
+bool INesMapper004Write(INesInstance* instance, uint16_t addr, uint8_t data) {
     assert(addr >= 0x4020 || addr < 0x2000);
     
     bool odd = addr & 1;
@@ -219,12 +196,14 @@ void INesMapper004Write(INesInstance* instance, uint16_t addr, uint8_t data) {
         if (odd) {
             mapper004->PRGRAMProtect = data;
         } else {
+            bool changed = mapper004->mirroring != (data & 1);
             mapper004->mirroring = data & 1;
             if (mapper004->mirroring) {
                 instance->mirror = INesInstanceMirrorHorizontal;
             } else {
                 instance->mirror = INesInstanceMirrorVertical;
             }
+            return changed;
         }
     } else if (addr >= 0x8000) {
         if (odd) {
@@ -238,17 +217,23 @@ void INesMapper004Write(INesInstance* instance, uint16_t addr, uint8_t data) {
                 data %= mapper004->instance->file->CHRBankCount;
             }
             assert(mapper004->RValue <= 7);
+            bool changed = mapper004->bankData[mapper004->RValue] != data;
             mapper004->bankData[mapper004->RValue] = data;
+            return changed;
         } else {
+            // 只选择下一次写入的寄存器时映射不变
+            bool changed = mapper004->CHRA12Invention != (bool)(data & 0x80) || mapper004->PRGROMBankMode != (bool)(data & 0x40);
             mapper004->CHRA12Invention = data & 0x80;
             mapper004->PRGROMBankMode = data & 0x40;
             mapper004->RValue = data & 7;
+            return changed;
         }
     } else if (addr >= 0x6000) {
         INesFileWriteRam(instance->file, addr - 0x6000, data);
     } else if (addr < 0x2000) {
         INesMapper004CHRWrite(instance, addr, data);
     }
+    return false;
 }
 
 uint8_t INesMapper004Read(INesInstance* instance, uint16_t addr) {
@@ -288,3 +273,60 @@ void INesMapper004PPUTick(INesInstance* instance) {
         }
     }
 }
+
+int32_t INesMapper004PRGOffset(INesInstance* instance, uint16_t addr) {
+    if (addr < 0x8000) {
+        return -1;
+    }
+    
+    INesMapper004* mapper004 = (INesMapper004*)instance->mapper->data;
+    uint32_t cvt = 0;
+    uint8_t R = 0;
+    uint32_t B = 0;
+    
+    if (addr >= 0xe000) {
+        // last bank
+        return (int32_t)(instance->file->PRGRomSize - 0x2000 + addr - 0xe000);
+    } else if (addr >= 0xc000) {
+        if (mapper004->PRGROMBankMode) {
+            R = 6;
+            B = 0xc000;
+        } else {
+            // penultimate
+            return (int32_t)(instance->file->PRGRomSize - 0x4000 + addr - 0xc000);
+        }
+    } else if (addr >= 0xa000) {
+        R = 7;
+        B = 0xa000;
+    } else {
+        assert(addr >= 0x8000);
+        if (mapper004->PRGROMBankMode) {
+            // penultimate
+            return (int32_t)(instance->file->PRGRomSize - 0x4000 + addr - 0x8000);
+        } else {
+            R = 6;
+            B = 0x8000;
+        }
+    }
+    cvt = switchPRGBankAddr(mapper004, R, addr, B);
+    if (cvt >= instance->file->PRGRomSize) {
+        return -1;
+    }
+    
+    return (int32_t)cvt;
+}
+
+int32_t INesMapper004PRGRAMOffset(INesInstance*, uint16_t addr) {
+    if (addr < 0x6000 || addr >= 0x8000) {
+        return -1;
+    }
+    return addr - 0x6000;
+}
+
+int32_t INesMapper004CHROffset(INesInstance* instance, uint16_t addr) {
+    uint32_t cvt = INesMapper004SwitchCHRAddr(instance, addr);
+    if (cvt >= instance->file->CHRRomSize) {
+        return -1;
+    }
+    return (int32_t)cvt;
+}
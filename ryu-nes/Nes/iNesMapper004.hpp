@@ -6,8 +6,11 @@
 #include <stdio.h>
 
 bool INesMapper004Init(INesInstance* instance);
-void INesMapper004Write(INesInstance* instance, uint16_t addr, uint8_t data);
+bool INesMapper004Write(INesInstance* instance, uint16_t addr, uint8_t data);
 uint8_t INesMapper004Read(INesInstance* instance, uint16_t addr);
+int32_t INesMapper004PRGOffset(INesInstance* instance, uint16_t addr);
+int32_t INesMapper004CHROffset(INesInstance* instance, uint16_t addr);
+int32_t INesMapper004PRGRAMOffset(INesInstance* instance, uint16_t addr);
 void INesMapper004PPUTick(INesInstance* instance);
 
 #endif /* iNesMapper004_hpp */
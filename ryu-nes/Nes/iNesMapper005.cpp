@@ -42,7 +42,8 @@ struct INesMapper005 {
     uint8_t scanlineCounter;
 };
 
-static uint8_t INesMapper005ReadPRG(INesInstance* instance, size_t range0, size_t range1, size_t reg, size_t addr) {
+// 返回 PRG ROM 偏移，映射到 PRG RAM 时返回 -1 并通过 outRamAddr 输出 PRG RAM 偏移
+static int32_t INesMapper005MappingPRGAddr(INesInstance* instance, size_t range0, size_t range1, size_t reg, size_t addr, size_t* outRamAddr) {
     assert(reg >= 0x5113 && reg <= 0x5117);
     assert(addr >= range0 && addr <= range1);
     assert(((range1 - range0) & 0xfff) == 0xfff);
@@ -65,11 +66,49 @@ static uint8_t INesMapper005ReadPRG(INesInstance* instance, size_t range0, size_
     
     if (reg >= 0x5114 && reg <= 0x5116 && !(regValue >> 7)) {
         bank &= 0xf;
-        return INesFileReadRam(instance->file, addr - range0 + (bank << 13));
+        *outRamAddr = addr - range0 + (bank << 13);
+        return -1;
     }
     
     bank %= instance->file->PRGBankCount;
-    return INesFileReadRom(instance->file, addr - range0 + (bank << 13));
+    return (int32_t)(addr - range0 + (bank << 13));
+}
+
+static int32_t INesMapper005MappingPRGWindow(INesInstance* instance, uint16_t addr, size_t* outRamAddr) {
+    assert(addr >= 0x8000);
+    INesMapper005* mapper005 = (INesMapper005*)instance->mapper->data;
+    
+    if (mapper005->PRGBankMode == 0) {
+        return INesMapper005MappingPRGAddr(instance, 0x8000, 0xffff, 0x5117, addr, outRamAddr);
+    } else if (mapper005->PRGBankMode == 1) {
+        if (addr >= 0x8000 && addr <= 0xbfff) {
+            return INesMapper005MappingPRGAddr(instance, 0x8000, 0xbfff, 0x5115, addr, outRamAddr);
+        } else {
+            assert(addr >= 0xc000 && addr <= 0xffff);
+            return INesMapper005MappingPRGAddr(instance, 0xc000, 0xffff, 0x5117, addr, outRamAddr);
+        }
+    } else if (mapper005->PRGBankMode == 2) {
+        if (addr >= 0x8000 && addr <= 0xbfff) {
+            return INesMapper005MappingPRGAddr(instance, 0x8000, 0xbfff, 0x5115, addr, outRamAddr);
+        } else if (addr >= 0xc000 && addr <= 0xdfff) {
+            return INesMapper005MappingPRGAddr(instance, 0xc000, 0xdfff, 0x5116, addr, outRamAddr);
+        } else {
+            assert(addr >= 0xe000 && addr <= 0xffff);
+            return INesMapper005MappingPRGAddr(instance, 0xe000, 0xffff, 0x5117, addr, outRamAddr);
+        }
+    } else {
+        assert(mapper005->PRGBankMode == 3);
+        if (addr >= 0x8000 && addr <= 0x9fff) {
+            return INesMapper005MappingPRGAddr(instance, 0x8000, 0x9fff, 0x5114, addr, outRamAddr);
+        } else if (addr >= 0xa000 && addr <= 0xbfff) {
+            return INesMapper005MappingPRGAddr(instance, 0xa000, 0xbfff, 0x5115, addr, outRamAddr);
+        } else if (addr >= 0xc000 && addr <= 0xdfff) {
+            return INesMapper005MappingPRGAddr(instance, 0xc000, 0xdfff, 0x5116, addr, outRamAddr);
+        } else {
+            assert(addr >= 0xe000 && addr <= 0xffff);
+            return INesMapper005MappingPRGAddr(instance, 0xe000, 0xffff, 0x5117, addr, outRamAddr);
+        }
+    }
 }
 
 static uint8_t INesMapper005ReadCHR(INesInstance* instance, size_t range0, size_t range1, size_t reg, size_t addr) {
@@ -125,6 +164,7 @@ bool INesMapper005Init(INesInstance* instance) {
     }
     
     instance->mapper->data = malloc(sizeof(INesMapper005));
+    instance->mapper->dataSize = sizeof(INesMapper005);
     memset(instance->mapper->data, 0, sizeof(INesMapper005));
     
     INesMapper005* mapper005 = (INesMapper005*)instance->mapper->data;
@@ -136,7 +176,7 @@ bool INesMapper005Init(INesInstance* instance) {
     return true;
 }
 
-void INesMapper005Write(INesInstance* instance, uint16_t addr, uint8_t data) {
+bool INesMapper005Write(INesInstance* instance, uint16_t addr, uint8_t data) {
     assert(addr >= 0x4020 || addr < 0x2000);
     
     INesMapper005* mapper005 = (INesMapper005*)instance->mapper->data;
@@ -201,6 +241,8 @@ void INesMapper005Write(INesInstance* instance, uint16_t addr, uint8_t data) {
         size_t addr = ((size_t)mapper005->PRGSelectBanks[0] << 13) + (size_t)offset;
         INesFileWriteRam(instance->file, addr, data);
     }
+    // PRG/CHR 的 bank 模式、bank 选择和命名表映射
+    return addr == 0x5100 || addr == 0x5101 || addr == 0x5105 || (addr >= 0x5113 && addr <= 0x5117) || (addr >= 0x5120 && addr <= 0x512b) || addr == 0x5130;
 }
 
 uint8_t INesMapper005Read(INesInstance* instance, uint16_t addr) {
@@ -225,36 +267,12 @@ uint8_t INesMapper005Read(INesInstance* instance, uint16_t addr) {
         size_t addr = ((size_t)mapper005->PRGSelectBanks[0] << 13) + (size_t)offset;
         data = INesFileReadRam(instance->file, addr);
     } else if (addr >= 0x8000 && addr <= 0xffff) {
-        if (mapper005->PRGBankMode == 0) {
-            data = INesMapper005ReadPRG(instance, 0x8000, 0xffff, 0x5117, addr);
-        } else if (mapper005->PRGBankMode == 1) {
-            if (addr >= 0x8000 && addr <= 0xbfff) {
-                data = INesMapper005ReadPRG(instance, 0x8000, 0xbfff, 0x5115, addr);
-            } else {
-                assert(addr >= 0xc000 && addr <= 0xffff);
-                data = INesMapper005ReadPRG(instance, 0xc000, 0xffff, 0x5117, addr);
-            }
-        } else if (mapper005->PRGBankMode == 2) {
-            if (addr >= 0x8000 && addr <= 0xbfff) {
-                data = INesMapper005ReadPRG(instance, 0x8000, 0xbfff, 0x5115, addr);
-            } else if (addr >= 0xc000 && addr <= 0xdfff) {
-                data = INesMapper005ReadPRG(instance, 0xc000, 0xdfff, 0x5116, addr);
-            } else {
-                assert(addr >= 0xe000 && addr <= 0xffff);
-                data = INesMapper005ReadPRG(instance, 0xe000, 0xffff, 0x5117, addr);
-            }
+        size_t ramAddr = 0;
+        int32_t romAddr = INesMapper005MappingPRGWindow(instance, addr, &ramAddr);
+        if (romAddr < 0) {
+            data = INesFileReadRam(instance->file, ramAddr);
         } else {
-            assert(mapper005->PRGBankMode == 3);
-            if (addr >= 0x8000 && addr <= 0x9fff) {
-                data = INesMapper005ReadPRG(instance, 0x8000, 0x9fff, 0x5114, addr);
-            } else if (addr >= 0xa000 && addr <= 0xbfff) {
-                data = INesMapper005ReadPRG(instance, 0xa000, 0xbfff, 0x5115, addr);
-            } else if (addr >= 0xc000 && addr <= 0xdfff) {
-                data = INesMapper005ReadPRG(instance, 0xc000, 0xdfff, 0x5116, addr);
-            } else {
-                assert(addr >= 0xe000 && addr <= 0xffff);
-                data = INesMapper005ReadPRG(instance, 0xe000, 0xffff, 0x5117, addr);
-            }
+            data = INesFileReadRom(instance->file, romAddr);
         }
     } else if (addr >= 0 && addr <= 0x1fff) {
         if (instance->ppu->sps == 0 || instance->ppu->fetchSprite) {
@@ -406,3 +424,19 @@ void INesMapper005PPUTick(INesInstance* instance) {
         mapper005->scanlineCounter = 0xff;
     }
 }
+
+int32_t INesMapper005PRGOffset(INesInstance* instance, uint16_t addr) {
+    if (addr < 0x8000) {
+        return -1;
+    }
+    size_t ramAddr = 0;
+    return INesMapper005MappingPRGWindow(instance, addr, &ramAddr);
+}
+
+int32_t INesMapper005PRGRAMOffset(INesInstance* instance, uint16_t addr) {
+    if (addr < 0x6000 || addr >= 0x8000) {
+        return -1;
+    }
+    INesMapper005* mapper005 = (INesMapper005*)instance->mapper->data;
+    return (int32_t)(((size_t)mapper005->PRGSelectBanks[0] << 13) + (size_t)(addr - 0x6000));
+}
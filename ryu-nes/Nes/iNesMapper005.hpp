@@ -6,8 +6,10 @@
 #include <stdio.h>
 
 bool INesMapper005Init(INesInstance* instance);
-void INesMapper005Write(INesInstance* instance, uint16_t addr, uint8_t data);
+bool INesMapper005Write(INesInstance* instance, uint16_t addr, uint8_t data);
 uint8_t INesMapper005Read(INesInstance* instance, uint16_t addr);
+int32_t INesMapper005PRGOffset(INesInstance* instance, uint16_t addr);
+int32_t INesMapper005PRGRAMOffset(INesInstance* instance, uint16_t addr);
 void INesMapper005WriteNameTable(INesInstance* instance, uint16_t addr, uint8_t data);
 uint8_t INesMapper005ReadNameTable(INesInstance* instance, uint16_t addr);
 void INesMapper005PPUTick(INesInstance* instance);
@@ -34,7 +34,7 @@ static uint32_t switchPRGBankAddr(INesMapper074* mapper074, uint8_t R, uint32_t
     return (bank << 13) + (addr - base);
 }
 
-static uint32_t INesMapper074MappingCHRAddr(INesInstance* instance, uint16_t addr, uint32_t* outBank) {
+static uint32_t INesMapper074SwitchCHRAddr(INesInstance* instance, uint16_t addr, uint32_t* outBank) {
     assert(addr < 0x2000);
     INesMapper074* mapper074 = (INesMapper074*)instance->mapper->data;
     uint32_t cvt = 0;
@@ -109,6 +109,11 @@ static uint32_t INesMapper074MappingCHRAddr(INesInstance* instance, uint16_t add
     }
     
     cvt = switchCHRBankAddr(mapper074, R, addr, B, outBank);
+    return cvt;
+}
+
+static uint32_t INesMapper074MappingCHRAddr(INesInstance* instance, uint16_t addr, uint32_t* outBank) {
+    uint32_t cvt = INesMapper074SwitchCHRAddr(instance, addr, outBank);
     
     if (cvt >= instance->file->CHRRomSize) {
         return 0;
@@ -148,37 +153,8 @@ static void INesMapper074CHRWrite(INesInstance* instance, uint16_t addr, uint8_t
 static uint8_t INesMapper074PRGRead(INesInstance* instance, uint16_t addr) {
     assert(addr >= 0x8000);
     
-    INesMapper074* mapper074 = (INesMapper074*)instance->mapper->data;
-    uint32_t cvt = 0;
-    uint8_t R = 0;
-    uint32_t B = 0;
-    
-    if (addr >= 0xe000) {
-        // last bank
-        return instance->file->PRGRom[instance->file->PRGRomSize - 0x2000 + addr - 0xe000];
-    } else if (addr >= 0xc000) {
-        if (mapper074->PRGROMBankMode) {
-            R = 6;
-            B = 0xc000;
-        } else {
-            // penultimate
-            return instance->file->PRGRom[instance->file->PRGRomSize - 0x4000 + addr - 0xc000];
-        }
-    } else if (addr >= 0xa000) {
-        R = 7;
-        B = 0xa000;
-    } else {
-        assert(addr >= 0x8000);
-        if (mapper074->PRGROMBankMode) {
-            // penultimate
-            return instance->file->PRGRom[instance->file->PRGRomSize - 0x4000 + addr - 0x8000];
-        } else {
-            R = 6;
-            B = 0x8000;
-        }
-    }
-    cvt = switchPRGBankAddr(mapper074, R, addr, B);
-    if (cvt >= instance->file->PRGRomSize) {
+    int32_t cvt = INesMapper074PRGOffset(instance, addr);
+    if (cvt < 0) {
         return 0;
     }
     
@@ -204,13 +180,14 @@ bool INesMapper074Init(INesInstance* instance) {
     }
     
     instance->mapper->data = malloc(sizeof(INesMapper074));
+    instance->mapper->dataSize = sizeof(INesMapper074);
     memset(instance->mapper->data, 0, sizeof(INesMapper074));
     ((INesMapper074*)instance->mapper->data)->instance = instance;
     
     return true;
 }
 
-void INesMapper074Write(INesInstance* instance, uint16_t addr, uint8_t data) {
+bool INesMapper074Write(INesInstance* instance, uint16_t addr, uint8_t data) {
     assert(addr >= 0x4020 || addr < 0x2000);
     
     bool odd = addr & 1;
@@ -232,12 +209,14 @@ void INesMapper074Write(INesInstance* instance, uint16_t addr, uint8_t data) {
         if (odd) {
             mapper074->PRGRAMProtect = data;
         } else {
+            bool changed = mapper074->mirroring != (data & 1);
             mapper074->mirroring = data & 1;
             if (mapper074->mirroring) {
                 instance->mirror = INesInstanceMirrorHorizontal;
             } else {
                 instance->mirror = INesInstanceMirrorVertical;
             }
+            return changed;
         }
     } else if (addr >= 0x8000) {
         if (odd) {
@@ -251,17 +230,23 @@ void INesMapper074Write(INesInstance* instance, uint16_t addr, uint8_t data) {
                 data %= mapper074->instance->file->CHRBankCount;
             }
             assert(mapper074->RValue <= 7);
+            bool changed = mapper074->bankData[mapper074->RValue] != data;
             mapper074->bankData[mapper074->RValue] = data;
+            return changed;
         } else {
+            // 只选择下一次写入的寄存器时映射不变
+            bool changed = mapper074->CHRA12Invention != (bool)(data & 0x80) || mapper074->PRGROMBankMode != (bool)(data & 0x40);
             mapper074->CHRA12Invention = data & 0x80;
             mapper074->PRGROMBankMode = data & 0x40;
             mapper074->RValue = data & 7;
+            return changed;
         }
     } else if (addr >= 0x6000) {
         INesFileWriteRam(instance->file, addr - 0x6000, data);
     } else if (addr < 0x2000) {
         INesMapper074CHRWrite(instance, addr, data);
     }
+    return false;
 }
 
 uint8_t INesMapper074Read(INesInstance* instance, uint16_t addr) {
@@ -301,3 +286,68 @@ void INesMapper074PPUTick(INesInstance* instance) {
         }
     }
 }
+
+int32_t INesMapper074PRGOffset(INesInstance* instance, uint16_t addr) {
+    if (addr < 0x8000) {
+        return -1;
+    }
+    
+    INesMapper074* mapper074 = (INesMapper074*)instance->mapper->data;
+    uint32_t cvt = 0;
+    uint8_t R = 0;
+    uint32_t B = 0;
+    
+    if (addr >= 0xe000) {
+        // last bank
+        return (int32_t)(instance->file->PRGRomSize - 0x2000 + addr - 0xe000);
+    } else if (addr >= 0xc000) {
+        if (mapper074->PRGROMBankMode) {
+            R = 6;
+            B = 0xc000;
+        } else {
+            // penultimate
+            return (int32_t)(instance->file->PRGRomSize - 0x4000 + addr - 0xc000);
+        }
+    } else if (addr >= 0xa000) {
+        R = 7;
+        B = 0xa000;
+    } else {
+        assert(addr >= 0x8000);
+        if (mapper074->PRGROMBankMode) {
+            // penultimate
+            return (int32_t)(instance->file->PRGRomSize - 0x4000 + addr - 0x8000);
+        } else {
+            R = 6;
+            B = 0x8000;
+        }
+    }
+    cvt = switchPRGBankAddr(mapper074, R, addr, B);
+    if (cvt >= instance->file->PRGRomSize) {
+        return -1;
+    }
+    
+    return (int32_t)cvt;
+}
+
+int32_t INesMapper074PRGRAMOffset(INesInstance*, uint16_t addr) {
+    if (addr < 0x6000 || addr >= 0x8000) {
+        return -1;
+    }
+    return addr - 0x6000;
+}
+
+int32_t INesMapper074CHROffset(INesInstance* instance, uint16_t addr) {
+    if (instance->file->CHRRomSize == 0) {
+        return INesMapperCHRRAMOffset(instance, addr);
+    }
+    uint32_t bank = 0;
+    uint32_t cvt = INesMapper074SwitchCHRAddr(instance, addr, &bank);
+    if (bank == 8 || bank == 9) {
+        // bank 8, 9 为 2KB 的 CHR RAM
+        return INesMapperCHRRAMOffset(instance, (addr & 0x3ff) + ((bank - 8) << 10));
+    }
+    if (cvt >= instance->file->CHRRomSize) {
+        return -1;
+    }
+    return (int32_t)cvt;
+}
@@ -6,8 +6,11 @@
 #include <stdio.h>
 
 bool INesMapper074Init(INesInstance* instance);
-void INesMapper074Write(INesInstance* instance, uint16_t addr, uint8_t data);
+bool INesMapper074Write(INesInstance* instance, uint16_t addr, uint8_t data);
 uint8_t INesMapper074Read(INesInstance* instance, uint16_t addr);
+int32_t INesMapper074PRGOffset(INesInstance* instance, uint16_t addr);
+int32_t INesMapper074CHROffset(INesInstance* instance, uint16_t addr);
+int32_t INesMapper074PRGRAMOffset(INesInstance* instance, uint16_t addr);
 void INesMapper074PPUTick(INesInstance* instance);
 
 #endif /* iNesMapper074_hpp */
@@ -0,0 +1,121 @@
+#ifndef iNesMapperTraits_hpp
+#define iNesMapperTraits_hpp
+
+#include "iNesInstance.hpp"
+#include "iNesMapper001.hpp"
+#include "iNesMapper003.hpp"
+#include "iNesMapper004.hpp"
+
+// 编译期确定的 mapper。PPU 和主循环以它为模板参数实例化，CHR 读取可以内联，没有 PPU 时钟回调的 mapper 不产生调用。
+// NextPPUTickDot 返回从点 tx 开始下一个 PPUTick 会起作用的点，没有时返回 341，用于 INesPPUTickMapper 跳过空闲的点，以及计算 PPU 最多可以推迟执行到哪个点。
+// INesMapperTraitsDynamic 通过 iNesMapper 的函数表分发，用于其它 mapper。
+
+struct INesMapperTraitsNROM {
+    static const bool hasPPUTick = false;
+    static bool MapsNameTable(INesInstance*) { return false; }
+    static uint8_t ReadCHR(INesInstance* instance, uint16_t addr) { return instance->file->CHRRom[addr]; }
+    static void PPUTick(INesInstance*) {}
+    static uint16_t NextPPUTickDot(INesInstance*, uint16_t) { return 341; }
+};
+
+struct INesMapperTraitsMMC1 {
+    static const bool hasPPUTick = false;
+    static bool MapsNameTable(INesInstance*) { return false; }
+    static uint8_t ReadCHR(INesInstance* instance, uint16_t addr) { return INesMapper001Read(instance, addr); }
+    static void PPUTick(INesInstance*) {}
+    static uint16_t NextPPUTickDot(INesInstance*, uint16_t) { return 341; }
+};
+
+// CHR RAM
+struct INesMapperTraitsUxROM {
+    static const bool hasPPUTick = false;
+    static bool MapsNameTable(INesInstance*) { return false; }
+    static uint8_t ReadCHR(INesInstance* instance, uint16_t addr) { return instance->ppu->mem[addr]; }
+    static void PPUTick(INesInstance*) {}
+    static uint16_t NextPPUTickDot(INesInstance*, uint16_t) { return 341; }
+};
+
+struct INesMapperTraitsCNROM {
+    static const bool hasPPUTick = false;
+    static bool MapsNameTable(INesInstance*) { return false; }
+    static uint8_t ReadCHR(INesInstance* instance, uint16_t addr) {
+        const INesMapper003* mapper003 = (const INesMapper003*)instance->mapper->data;
+        uint32_t cvtaddr = (((uint32_t)mapper003->bankSelectRegister & 3) << 13) + (uint32_t)addr;
+        return cvtaddr < instance->file->CHRRomSize ? instance->file->CHRRom[cvtaddr] : 0;
+    }
+    static void PPUTick(INesInstance*) {}
+    static uint16_t NextPPUTickDot(INesInstance*, uint16_t) { return 341; }
+};
+
+struct INesMapperTraitsMMC3 {
+    static const bool hasPPUTick = true;
+    static bool MapsNameTable(INesInstance*) { return false; }
+    static uint8_t ReadCHR(INesInstance* instance, uint16_t addr) { return INesMapper004Read(instance, addr); }
+    static void PPUTick(INesInstance* instance) { INesMapper004PPUTick(instance); }
+    // PPUTick 在 tx 递增之后调用，IRQ 计数器在 tx 变为 280 时计数，即执行点 279 的时钟
+    static uint16_t NextPPUTickDot(INesInstance*, uint16_t tx) { return tx <= 279 ? 279 : 341; }
+};
+
+struct INesMapperTraitsDynamic {
+    static const bool hasPPUTick = true;
+    static bool MapsNameTable(INesInstance* instance) { return INesMapperRequireMappingNametable(instance); }
+    static uint8_t ReadCHR(INesInstance* instance, uint16_t addr) { return INesMapperRead(instance, addr); }
+    static void PPUTick(INesInstance* instance) { INesMapperPPUTick(instance); }
+    // MMC5 等每个点都会更新状态，不能跳过
+    static uint16_t NextPPUTickDot(INesInstance*, uint16_t tx) { return tx; }
+};
+
+#define INES_MAPPER_TRAITS_LIST(X) \
+    X(INesMapperTraitsNROM) \
+    X(INesMapperTraitsMMC1) \
+    X(INesMapperTraitsUxROM) \
+    X(INesMapperTraitsCNROM) \
+    X(INesMapperTraitsMMC3) \
+    X(INesMapperTraitsDynamic)
+
+template <typename Mapper>
+static inline uint8_t INesInstancePPUReadMapper(INesInstance* instance, uint16_t addr) {
+    addr = INesInstanceMappingPPUAddr(addr);
+    
+    if (addr >= 0x2000 && addr < 0x3000 && Mapper::MapsNameTable(instance)) {
+        return INesMapperReadNameTable(instance, addr);
+    }
+    
+    if (addr < 0x2000) {
+        return Mapper::ReadCHR(instance, addr);
+    }
+    if (addr >= 0x3f00) {
+        if (addr % 4 == 0) {
+            return instance->ppu->mem[0x3f00];
+        }
+        return instance->ppu->mem[addr];
+    }
+    if (instance->mirror == INesInstanceMirrorVertical) {
+        if (addr >= 0x2800) {
+            addr -= 0x800;
+        }
+    } else if (instance->mirror == INesInstanceMirrorHorizontal) {
+        if (addr >= 0x2400 && addr < 0x2c00) {
+            addr -= 0x0400;
+        } else if (addr >= 0x2c00) {
+            addr -= 0x0800;
+        }
+    }
+    
+    return instance->ppu->mem[addr];
+}
+
+// 实现在 iNesPPU.cpp，只对上面列出的 mapper 实例化
+template <typename Mapper>
+void INesPPURunMapper(INesInstance* instance);
+
+template <typename Mapper>
+void INesPPUCatchUpMapper(INesInstance* instance, bool write);
+
+#define INES_MAPPER_TRAITS_EXTERN_PPU_TICK(Mapper) \
+    extern template void INesPPURunMapper<Mapper>(INesInstance* instance); \
+    extern template void INesPPUCatchUpMapper<Mapper>(INesInstance* instance, bool write);
+INES_MAPPER_TRAITS_LIST(INES_MAPPER_TRAITS_EXTERN_PPU_TICK)
+#undef INES_MAPPER_TRAITS_EXTERN_PPU_TICK
+
+#endif /* iNesMapperTraits_hpp */
@@ -1,4 +1,9 @@
 #include "iNesPPU.hpp"
+#include "iNesMapperTraits.hpp"
+#include "iNesTileCache.hpp"
+#include "iNesPPUComposite.hpp"
+#include "iNesPPUFramebuffer.hpp"
+#include "iNesPPUThread.hpp"
 #include <assert.h>
 #include <string.h>
 #include <inttypes.h>
@@ -490,6 +495,7 @@ static uint16_t INesPPUGetSprPatternBaseAddr(INesInstance* instance);
  *
  * 返回: 空
  */
+template <typename Mapper>
 static void INesPPUFillBgRegister(INesInstance* instance);
 
 /*
@@ -517,6 +523,15 @@ void INesPPUGetColorByPalleteIndex(uint8_t index, uint8_t* r, uint8_t* g, uint8_
 
 uint8_t INesPPUReadPort(INesInstance* instance, uint16_t addr) {
     assert((addr >= 0x2000 && addr <= 0x2007) || addr == 0x4014);
+    // 读取 PPUDATA 会递增 v，与写入一样影响之后的渲染
+    if (addr == 0x2007) {
+        INesPPUCatchUp(instance);
+    } else {
+        INesPPUSync(instance);
+    }
+    if (addr == 0x2002 || addr == 0x2007) {
+        INesPPUThreadRecord(instance, INesPPUThreadEntryRead, addr, 0);
+    }
     if (addr == 0x2000) {
         return INesPPUReadCtrl(instance);
     }
@@ -559,6 +574,10 @@ uint8_t INesPPUReadPort(INesInstance* instance, uint16_t addr) {
 
 void INesPPUWritePort(INesInstance* instance, uint16_t addr, uint8_t data) {
     assert((addr >= 0x2000 && addr <= 0x2007) || addr == 0x4014);
+    INesPPUCatchUp(instance);
+    if (addr != 0x4014) {
+        INesPPUThreadRecord(instance, INesPPUThreadEntryWrite, addr, data);
+    }
     if (addr == 0x2000) {
         return INesPPUWriteCtrl(instance, data);
     }
@@ -608,7 +627,11 @@ static void INesPPUWriteCtrl(INesInstance* instance, uint8_t data) {
     instance->ppu->vac = (data >> 2) & 1;
     instance->ppu->spt = (data >> 3) & 1;
     instance->ppu->bgt = (data >> 4) & 1;
-    instance->ppu->sps = (data >> 5) & 1;
+    uint8_t sps = (data >> 5) & 1;
+    if (instance->ppu->sps != sps) {
+        instance->ppu->sps = sps;
+        instance->ppu->spriteListsDirty = true;
+    }
     instance->ppu->mss = (data >> 6) & 1;
     instance->ppu->vbi = (data >> 7) & 1;
 }
@@ -627,13 +650,20 @@ static void INesPPUWriteMask(INesInstance* instance, uint8_t data) {
     instance->ppu->emr = (data >> 5) & 1;
     instance->ppu->emg = (data >> 6) & 1;
     instance->ppu->emb = (data >> 7) & 1;
+    INesPPUUpdatePalette(instance);
 }
 
-static uint8_t INesPPUReadStatus(INesInstance* instance) {
+uint8_t INesPPUPeekStatus(INesInstance* instance) {
+    INesPPUSync(instance);
     uint8_t data = instance->ppu->iodb & 0x1f; // 该 5 位数据读取到的是 iodb 总线的值
     data |= instance->ppu->ovf << 5;
     data |= instance->ppu->s0h << 6;
     data |= instance->ppu->vbs << 7;
+    return data;
+}
+
+static uint8_t INesPPUReadStatus(INesInstance* instance) {
+    uint8_t data = INesPPUPeekStatus(instance);
     instance->ppu->w = 0; // 每次读取 PPUSTATUS 都会将 PPU 的切换位清零
     instance->ppu->vbs = 0; // 每次读取 PPUSTATUS 都会将第 7 位（VBlank）清零
     instance->ppu->iodb = data; // 因为 PPUSTATUS 是可读寄存器，所以会将读取的值同步给 iodb 总线
@@ -665,6 +695,7 @@ static void INesPPUWriteOAMDATA(INesInstance* instance, uint8_t data) {
     }
     instance->ppu->iodb = data;
     instance->ppu->oam[instance->ppu->odr] = data;
+    instance->ppu->spriteListsDirty = true;
     ++instance->ppu->odr;
 }
 
@@ -733,6 +764,8 @@ void INesPPUWriteOAMDMA(INesInstance* instance, uint8_t data) {
     uint16_t base = (uint16_t)data << 8;
     for (uint16_t i = 0; i <= 0xff; ++i) {
         uint8_t v = INesInstanceRead(instance, base + i);
+        // 后台线程不能读取 CPU 内存，按 $2004 写入记录
+        INesPPUThreadRecord(instance, INesPPUThreadEntryWrite, 0x2004, v);
         INesPPUWriteOAMDATA(instance, v);
     }
     instance->ppu->iodb = data;
@@ -748,82 +781,435 @@ void INesPPUReset(INesInstance* instance) {
     memset(instance->ppu, 0, sizeof(INesPPU));
     // 将扫描线初始化在预渲染扫描线。
     instance->ppu->ty = 261;
+    instance->ppu->spriteListsDirty = true;
+    INesPPUUpdatePalette(instance);
 }
 
-void INesPPUTick(INesInstance* instance) {
+void INesPPUUpdatePalette(INesInstance* instance) {
+    INesPPU* ppu = instance->ppu;
+    uint8_t mask = ppu->grs ? 0x30 : 0x3f;
+    for (uint16_t i = 0; i < 32; ++i) {
+        ppu->palette[i] = ppu->mem[(i % 4 == 0) ? 0x3f00 : 0x3f00 + i] & mask;
+    }
+}
+
+/*
+ * 函数: INesPPURenderBgDot
+ * ------------------------
+ * 计算可视扫描线上第 tx 个点的背景像素，写入 bg_p/bg_d，与原来在 INesPPUTick 中每个时钟执行的背景逻辑相同。
+ * 只在开启渲染时调用，合成由 INesPPURenderDots 对整段一起进行。
+ *
+ * 参数 1 instance: Nes 实例
+ * 参数 2 tx: 0~255 的点
+ *
+ * 返回: 空
+ */
+template <typename Mapper>
+static void INesPPURenderBgDot(INesInstance* instance, uint16_t tx) {
+    INesPPU* ppu = instance->ppu;
+    if (tx % 8 == 0) {
+        INesPPUFillBgRegister<Mapper>(instance);
+        instance->ppu->v = INesPPUGetVRAMByCoarseXInc(instance->ppu->v);
+    } else {
+        ppu->bgs16[0] <<= 1;
+        ppu->bgs16[1] <<= 1;
+        ppu->bgs8[0] = (ppu->bgs8[0] >> 1) | (ppu->bgb8[0] << 7);
+        ppu->bgs8[1] = (ppu->bgs8[1] >> 1) | (ppu->bgb8[1] << 7);
+    }
+    // 输出背景像素
+    uint8_t bit0 = (ppu->bgs16[0] >> (15 - ppu->x)) & 1;
+    uint8_t bit1 = ((ppu->bgs16[1] >> (15 - ppu->x)) & 1) << 1;
+    uint8_t bit2 = ((ppu->bgs8[0] >> ppu->x) & 1) << 2;
+    uint8_t bit3 = ((ppu->bgs8[1] >> ppu->x) & 1) << 3;
+    uint8_t palette = bit0 | bit1 | bit2 | bit3;
+    
+    if (!(palette & 3)) {
+        palette = 0;
+    }
+    assert(palette < 16);
+    ppu->bg_p[tx] = palette;
+    ppu->bg_d[tx] = ppu->palette[palette];
+}
+
+/*
+ * 函数: INesPPUGetPatternRow
+ * --------------------------
+ * 取得图案表中一行 8 个像素的图案值（0~3），优先使用 tile 缓存。
+ * 不能按页直接映射 CHR 的 mapper（MMC5）逐字节读取后解码到 buffer。
+ *
+ * 参数 1 instance: Nes 实例
+ * 参数 2 addr: 图案表中这一行低位平面的地址
+ * 参数 3 flip: 为 true 时返回水平翻转后的像素
+ * 参数 4 buffer: 不能使用缓存时存放解码结果，至少 8 字节
+ *
+ * 返回: 8 个像素
+ */
+template <typename Mapper>
+static inline const uint8_t* INesPPUGetPatternRow(INesInstance* instance, uint16_t addr, bool flip, uint8_t* buffer) {
+    const uint8_t* row = INesTileCacheGetRow(instance, addr, flip);
+    if (row) {
+        return row;
+    }
+    uint8_t lo = INesInstancePPUReadMapper<Mapper>(instance, addr);
+    uint8_t hi = INesInstancePPUReadMapper<Mapper>(instance, addr + 8);
+    for (int x = 0; x < 8; ++x) {
+        buffer[flip ? 7 - x : x] = ((lo >> (7 - x)) & 1) | (((hi >> (7 - x)) & 1) << 1);
+    }
+    return buffer;
+}
+
+/*
+ * 函数: INesPPUBuildSpriteLists
+ * -----------------------------
+ * 按 OAM 中的 Y 坐标把精灵分到它覆盖的各条扫描线，每行只需要处理自己的不超过 9 个精灵，不再每行扫描 64 个。
+ *
+ * 参数 1 ppu: PPU
+ *
+ * 返回: 空
+ */
+static void INesPPUBuildSpriteLists(INesPPU* ppu) {
+    memset(ppu->spriteListCount, 0, sizeof(ppu->spriteListCount));
+    uint16_t spriteHeight = 8 << ppu->sps;
+    for (uint8_t spriteIndex = 0; spriteIndex < 64; ++spriteIndex) {
+        uint16_t y = ppu->oam[spriteIndex << 2];
+        if (y >= 239) {
+            continue;
+        }
+        uint16_t end = y + spriteHeight < 240 ? y + spriteHeight : 240;
+        for (uint16_t line = y; line < end; ++line) {
+            uint8_t count = ppu->spriteListCount[line];
+            if (count < 9) {
+                ppu->spriteLists[line][count] = spriteIndex;
+                ppu->spriteListCount[line] = count + 1;
+            }
+        }
+    }
+    ppu->spriteListsDirty = false;
+}
+
+/*
+ * 函数: INesPPURenderBgTiles
+ * --------------------------
+ * 计算可视扫描线上 [begin, end) 的背景像素，写入 bg_p/bg_d，begin 和 end 都是 8 的倍数，结果与逐点执行 INesPPURenderBgDot 相同。
+ * 逐点渲染时每个 tile 的第一个点读取当前和下一个 tile，这里 n 个 tile 只需要读取 n + 1 个 tile，每个读取一次，
+ * 像素直接按 fine x 从中取出，不再逐点移位寄存器。
+ *
+ * 参数 1 instance: Nes 实例
+ * 参数 2 begin: 0, 8, ..., 248
+ * 参数 3 end: 8, 16, ..., 256
+ *
+ * 返回: 空
+ */
+template <typename Mapper>
+static void INesPPURenderBgTiles(INesInstance* instance, uint16_t begin, uint16_t end) {
+    INesPPU* ppu = instance->ppu;
+    uint16_t fineY = (uint16_t)INesPPUGetFineY(instance);
+    uint16_t patternSelectAddr = INesPPUGetBgPatternBaseAddr(instance);
+    uint16_t count = (end - begin) >> 3;
+    
+    // 在点 begin, begin + 8, ..., end - 8 读取当前和下一个 tile，v 的 coarse x 递增 count 次
+    const uint8_t* pattern[33];
+    uint8_t patternBuffer[33][8];
+    uint8_t attribute[33];
+    uint16_t v = ppu->v;
+    for (uint16_t i = 0; i <= count; ++i) {
+        uint16_t patternAddr = patternSelectAddr + ((uint16_t)INesInstancePPUReadMapper<Mapper>(instance, INesPPUGetNameTableAddr(v)) << 4) + fineY;
+        pattern[i] = INesPPUGetPatternRow<Mapper>(instance, patternAddr, false, patternBuffer[i]);
+        uint8_t attrData = INesInstancePPUReadMapper<Mapper>(instance, INesPPUGetAttributeTableAddr(v));
+        uint8_t fineTile = ((v & 2) >> 1) | ((v & 0x40) >> 5);
+        attribute[i] = (attrData >> (fineTile << 1)) & 3;
+        if (i < count) {
+            v = INesPPUGetVRAMByCoarseXInc(v);
+        }
+    }
+    ppu->v = v;
+    
+    // 移位寄存器保持与逐点渲染完第 end - 1 个点相同的状态，之后逐点渲染或者下一行中途开启渲染时会用到
+    for (int i = 0; i < 2; ++i) {
+        uint8_t curr = (attribute[count - 1] >> i) & 1;
+        uint8_t next = (attribute[count] >> i) & 1;
+        uint16_t patternCurr = 0;
+        uint16_t patternNext = 0;
+        for (int x = 0; x < 8; ++x) {
+            patternCurr |= ((pattern[count - 1][x] >> i) & 1) << (7 - x);
+            patternNext |= ((pattern[count][x] >> i) & 1) << (7 - x);
+        }
+        ppu->bgs16[i] = (uint16_t)(((patternCurr << 8) | patternNext) << 7);
+        ppu->bgs8[i] = curr | (next ? 0xfe : 0);
+        ppu->bgb8[i] = next;
+    }
+    
+    const uint8_t* colors = ppu->palette;
+    uint8_t* bgPalette = ppu->bg_p;
+    uint8_t* bgColor = ppu->bg_d;
+    uint16_t fineX = ppu->x;
+    for (uint16_t tx = begin; tx < end; ++tx) {
+        uint16_t p = tx - begin + fineX;
+        uint8_t tile = (uint8_t)(p >> 3);
+        uint8_t palette = pattern[tile][p & 7];
+        if (palette) {
+            palette |= attribute[tile] << 2;
+        }
+        bgPalette[tx] = palette;
+        bgColor[tx] = colors[palette];
+    }
+}
+
+/*
+ * 函数: INesPPURenderLine
+ * -----------------------
+ * 一次渲染一整行可视扫描线的 256 个点，结果与逐点渲染相同。
+ * 背景由 INesPPURenderBgTiles 一次计算，再和精灵一起按整行合成。
+ * 只在开启渲染并且这一行中途没有寄存器、mapper 写入时使用。
+ *
+ * 参数 1 instance: Nes 实例
+ *
+ * 返回: 空
+ */
+template <typename Mapper>
+static void INesPPURenderLine(INesInstance* instance) {
     INesPPU* ppu = instance->ppu;
-    ++ppu->tick;
+    INesPPURenderBgTiles<Mapper>(instance, 0, 256);
+    
+    uint8_t backdrop = ppu->palette[0];
+    uint8_t* sprPalette = ppu->spr_p;
+    uint8_t* sprColor = ppu->spr_d;
+    // 读取 PPUSTATUS 之前会先追赶到当前的点，整行渲染时设置 sprite 0 hit 不会被提前观察到
+    if (INesPPUCompositeLine(ppu, ppu->output[ppu->ty], ppu->bg_p, ppu->bg_d, sprPalette, sprColor, backdrop) >= 0) {
+        ppu->s0h = 1;
+    }
+    memset(sprPalette, 0, 256);
+    memset(sprColor, backdrop, 256);
+}
+
+/*
+ * 函数: INesPPUSkipDots
+ * ---------------------
+ * 跳过渲染时代替 INesPPURenderDots，不读取 tile、不输出像素，只按逐点渲染的规则在点 0, 8, ..., 248 递增 v 的 coarse x 。
+ *
+ * 参数 1 instance: Nes 实例
+ * 参数 2 end: 同 INesPPURenderDots
+ *
+ * 返回: 空
+ */
+static void INesPPUSkipDots(INesInstance* instance, uint16_t end) {
+    INesPPU* ppu = instance->ppu;
+    if (ppu->bge || ppu->spe) {
+        for (uint16_t tx = (ppu->renderedDot + 7) & ~7; tx < end; tx += 8) {
+            ppu->v = INesPPUGetVRAMByCoarseXInc(ppu->v);
+        }
+    }
+    ppu->renderedDot = end;
+}
+
+/*
+ * 函数: INesPPURenderDots
+ * -----------------------
+ * 渲染当前可视扫描线上从 renderedDot 到 end 之前的点。
+ * 一整行都没有渲染过并且开启了渲染时使用 INesPPURenderLine。
+ * 否则完整的 tile 使用 INesPPURenderBgTiles，写入所在的 tile 使用 INesPPURenderBgDot，写入的位置精确到点，然后整段一起合成。
+ * 渲染完一整行后写入调用方设置的输出帧。
+ * 跳过渲染的帧只有 0 号精灵所在并且还没有发生 sprite 0 hit 的行需要渲染，其余行使用 INesPPUSkipDots 。
+ * 0 号精灵所在的行在这一行开始前已经确定，s0h 在这一行中只会从 0 变为 1，所以一行中只会从渲染切换到跳过，不会反过来。
+ *
+ * 参数 1 instance: Nes 实例
+ * 参数 2 end: 渲染到这个点之前（不包括），最大为 256
+ *
+ * 返回: 空
+ */
+template <typename Mapper>
+static void INesPPURenderDots(INesInstance* instance, uint16_t end) {
+    INesPPU* ppu = instance->ppu;
+    if (ppu->skipFrame && (!ppu->spriteZeroInLine || ppu->s0h)) {
+        INesPPUSkipDots(instance, end);
+        if (end == 256) {
+            ppu->spriteZeroInLine = false;
+        }
+        return;
+    }
+    if (ppu->renderedDot == 0 && end == 256 && (ppu->bge || ppu->spe)) {
+        INesPPURenderLine<Mapper>(instance);
+    } else if (ppu->bge || ppu->spe) {
+        // 两次写入之间渲染状态和调色板都不会变化，先计算这一段的背景，再一起合成
+        // 写入所在 tile 中的点逐点计算，中间完整的 tile 一起计算
+        uint16_t begin = ppu->renderedDot;
+        uint16_t tx = begin;
+        while (tx < end && tx % 8 != 0) {
+            INesPPURenderBgDot<Mapper>(instance, tx++);
+        }
+        uint16_t tileEnd = end & ~7;
+        if (tx < tileEnd) {
+            INesPPURenderBgTiles<Mapper>(instance, tx, tileEnd);
+            tx = tileEnd;
+        }
+        while (tx < end) {
+            INesPPURenderBgDot<Mapper>(instance, tx++);
+        }
+        uint8_t backdrop = ppu->palette[0];
+        if (INesPPUCompositeSpan(ppu, begin, end, ppu->output[ppu->ty], ppu->bg_p, ppu->bg_d, ppu->spr_p, ppu->spr_d, backdrop)) {
+            ppu->s0h = 1;
+        }
+        memset(ppu->spr_p + begin, 0, end - begin);
+        memset(ppu->spr_d + begin, backdrop, end - begin);
+    } else {
+        // 关闭渲染时输出背景色
+        uint16_t begin = ppu->renderedDot;
+        uint8_t backdrop = ppu->palette[0];
+        memset(ppu->output[ppu->ty] + begin, backdrop, end - begin);
+        memset(ppu->spr_p + begin, 0, end - begin);
+        memset(ppu->spr_d + begin, backdrop, end - begin);
+    }
+    ppu->renderedDot = end;
+    if (end == 256) {
+        ppu->spriteZeroInLine = false;
+        if (instance->framebuffer && !ppu->skipFrame) {
+            INesPPUFramebufferWriteLine(instance, ppu->ty);
+        }
+    }
+}
+
+template <typename Mapper>
+void INesPPUCatchUpMapper(INesInstance* instance, bool write) {
+    INesPPURunMapper<Mapper>(instance);
+    INesPPU* ppu = instance->ppu;
+    if (write) {
+        ppu->idleUntil = 0;
+    } else if (!ppu->spriteZeroInLine || ppu->s0h) {
+        return;
+    }
+    if (ppu->ty > 239) {
+        return;
+    }
+    uint16_t end = ppu->tx < 256 ? ppu->tx : 256;
+    if (end > ppu->renderedDot) {
+        INesPPURenderDots<Mapper>(instance, end);
+    }
+}
+
+void INesPPUCatchUp(INesInstance* instance) {
+    instance->catchUp(instance, true);
+}
+
+void INesPPUSync(INesInstance* instance) {
+    instance->catchUp(instance, false);
+}
+
+/*
+ * 函数: INesPPUGetIdleUntil
+ * -------------------------
+ * 计算当前扫描线上从 tx 开始下一个需要完整执行 INesPPUTickMapper 的点，在它之前的点都可以跳过。
+ * 点 257~320 重置 OAMADDR 和预渲染扫描线点 280~304 复制 t 到 v 在每个点的结果相同，只要区间内没有 CPU 写入，
+ * 执行第一个点即可；CPU 写入时 INesPPUCatchUp 会清零 idleUntil，所以只需要把区间的起点作为事件。
+ * 点 340 负责换行，总是完整执行。
+ *
+ * 参数 1 instance: Nes 实例
+ *
+ * 返回: 下一个需要完整执行的点
+ */
+template <typename Mapper>
+static uint16_t INesPPUGetIdleUntil(INesInstance* instance) {
+    INesPPU* ppu = instance->ppu;
+    uint16_t tx = ppu->tx;
+    uint16_t ty = ppu->ty;
+    bool rendering = ppu->bge || ppu->spe;
+    const uint16_t events[] = {
+        (ty <= 239 || ty == 261) ? (uint16_t)0 : (uint16_t)341,
+        (ty == 241 || ty == 261) ? (uint16_t)1 : (uint16_t)341,
+        ty <= 239 ? (uint16_t)255 : (uint16_t)341,
+        (rendering && (ty <= 239 || ty == 261)) ? (uint16_t)256 : (uint16_t)341,
+        (rendering && (ty <= 239 || ty == 261)) ? (uint16_t)257 : (uint16_t)341,
+        (rendering && ty == 261) ? (uint16_t)280 : (uint16_t)341,
+    };
+    uint16_t next = Mapper::NextPPUTickDot(instance, tx);
+    if (next > 340) {
+        next = 340;
+    }
+    for (uint16_t event : events) {
+        if (event >= tx && event < next) {
+            next = event;
+        }
+    }
+    return next;
+}
+
+/*
+ * 函数: INesPPUGetDeadline
+ * ------------------------
+ * 计算从当前的点开始最多可以推迟执行的点数。CPU 不访问 PPU 端口和 mapper 时，只能通过中断观察到 PPU：
+ * 点 (241, 1) 的 NMI 和 mapper PPUTick 产生的 IRQ，这两个点必须在 CPU 执行同一个时钟之前执行。
+ * NMI 不判断 vbi，mapper 的事件点也与寄存器无关，所以写入之后不需要重新计算。
+ *
+ * 参数 1 instance: Nes 实例
+ *
+ * 返回: 到下一个事件为止需要执行的点数，包括事件所在的点
+ */
+template <typename Mapper>
+static uint32_t INesPPUGetDeadline(INesInstance* instance) {
+    INesPPU* ppu = instance->ppu;
+    const uint32_t frameDots = 262 * 341;
+    const uint32_t nmiDot = 241 * 341 + 1;
+    uint32_t dot = (uint32_t)ppu->ty * 341 + ppu->tx;
+    uint32_t deadline = (nmiDot >= dot ? nmiDot - dot : nmiDot + frameDots - dot) + 1;
+    if (Mapper::hasPPUTick) {
+        uint16_t next = Mapper::NextPPUTickDot(instance, ppu->tx);
+        uint32_t distance = next - ppu->tx + 1;
+        if (next > 340) {
+            // 这一行没有事件时看下一行
+            next = Mapper::NextPPUTickDot(instance, 0);
+            distance = 341 - ppu->tx + next + 1;
+        }
+        if (next <= 340 && distance < deadline) {
+            deadline = distance;
+        }
+    }
+    return deadline;
+}
+
+template <typename Mapper>
+static void INesPPUTickMapper(INesInstance* instance) {
+    INesPPU* ppu = instance->ppu;
+    // 可视扫描线上的点先不渲染，到第 255 个点时整行一起渲染，中途有写入时由 INesPPUCatchUp 追赶
+    if (ppu->ty <= 239 && ppu->tx == 0) {
+        ppu->renderedDot = 0;
+    } else if (ppu->ty == 261 && ppu->tx == 0) {
+        // 第 239 行求值的精灵属于不存在的第 240 行，第 0 行不显示精灵
+        memset(ppu->spr_p, 0, sizeof(ppu->spr_p));
+        ppu->spriteZeroInLine = false;
+        // 由后台线程渲染时这里只计算程序能观察到的结果
+        ppu->skipFrame = instance->renderSkip || instance->renderThread;
+    }
     // 可视渲染范围
     if (ppu->bge || ppu->spe) {
         ppu->fetchSprite = false;
-        if (ppu->ty <= 239 && ppu->tx <= 255) {
-            // background
-            if (ppu->tx % 8 == 0) {
-                INesPPUFillBgRegister(instance);
-                instance->ppu->v = INesPPUGetVRAMByCoarseXInc(instance->ppu->v);
-            } else {
-                ppu->bgs16[0] <<= 1;
-                ppu->bgs16[1] <<= 1;
-                ppu->bgs8[0] = (ppu->bgs8[0] >> 1) | (ppu->bgb8[0] << 7);
-                ppu->bgs8[1] = (ppu->bgs8[1] >> 1) | (ppu->bgb8[1] << 7);
-            }
-            // 输出背景像素
-            uint8_t bit0 = (ppu->bgs16[0] >> (15 - ppu->x)) & 1;
-            uint8_t bit1 = ((ppu->bgs16[1] >> (15 - ppu->x)) & 1) << 1;
-            uint8_t bit2 = ((ppu->bgs8[0] >> ppu->x) & 1) << 2;
-            uint8_t bit3 = ((ppu->bgs8[1] >> ppu->x) & 1) << 3;
-            uint8_t palette = bit0 | bit1 | bit2 | bit3;
-            
-            if (!(palette & 3)) {
-                palette = 0;
-            }
-            assert(palette < 16);
-            ppu->bg_p[ppu->ty][ppu->tx] = palette;
-            ppu->bg_d[ppu->ty][ppu->tx] = INesInstancePPURead(instance, 0x3f00 + palette) & 0x3f;
-            uint8_t spz = (ppu->spr_p[ppu->ty][ppu->tx] >> 5) & 1; // sprite number zero
-            uint8_t bgf = (ppu->spr_p[ppu->ty][ppu->tx] >> 4) & 1; // background in front
-            ppu->spr_p[ppu->ty][ppu->tx] &= 0x0f;
-            
-            if (ppu->bge && ppu->spe) {
-                ppu->output[ppu->ty][ppu->tx] = ppu->bg_d[ppu->ty][ppu->tx];
-                if ((!palette && ppu->spr_p[ppu->ty][ppu->tx]) || (!bgf && palette && ppu->spr_p[ppu->ty][ppu->tx])) {
-                    ppu->output[ppu->ty][ppu->tx] = ppu->spr_d[ppu->ty][ppu->tx];
-                }
-                if (spz && palette && ppu->spr_p[ppu->ty][ppu->tx]) {
-                    ppu->s0h = 1;
-                }
-            } else {
-                if (ppu->bge) {
-                    ppu->output[ppu->ty][ppu->tx] = ppu->bg_d[ppu->ty][ppu->tx];
-                }
-                else {
-                    ppu->output[ppu->ty][ppu->tx] = ppu->spr_d[ppu->ty][ppu->tx];
-                }
-            }
-            ppu->spr_p[ppu->ty][ppu->tx] = 0;
-            ppu->spr_d[ppu->ty][ppu->tx] = INesInstancePPURead(instance, 0x3f00 + 0) & 0x3f;
-        } // if (ppu->ty <= 239 && ppu->tx <= 255)
+        if (ppu->ty <= 239 && ppu->tx == 255) {
+            INesPPURenderDots<Mapper>(instance, 256);
+        }
         
         // sprites
         if (ppu->ty <= 239 && ppu->tx == 256) {
             ppu->fetchSprite = true;
+            if (ppu->spriteListsDirty) {
+                INesPPUBuildSpriteLists(ppu);
+            }
             uint16_t spritePatternAddr = INesPPUGetSprPatternBaseAddr(instance);
-            int spriteCount = 0;
             size_t spriteHeight = 8 << instance->ppu->sps;
+            const uint8_t* sprites = ppu->spriteLists[ppu->ty];
+            uint8_t spriteCount = ppu->spriteListCount[ppu->ty];
+            if (spriteCount > 8) {
+                // overflow
+                ppu->ovf = 1;
+                spriteCount = 8;
+            }
+            if (ppu->skipFrame) {
+                // 跳过渲染时只需要 0 号精灵，它在 OAM 顺序中总是排在第一个
+                spriteCount = (spriteCount > 0 && sprites[0] == 0 && !ppu->s0h) ? 1 : 0;
+            }
             
-            for (int spriteIndex = 0; spriteIndex < 64; ++spriteIndex) {
-                uint8_t i = (uint8_t)spriteIndex;
-                uint8_t baseIndex = i << 2;
+            for (uint8_t spriteSlot = 0; spriteSlot < spriteCount; ++spriteSlot) {
+                uint8_t spriteIndex = sprites[spriteSlot];
+                uint8_t baseIndex = spriteIndex << 2;
                 uint16_t ty = ppu->oam[baseIndex];
                 uint16_t tx = ppu->oam[baseIndex + 3];
-                
-                if (ty >= 239) {
-                    continue;
-                }
-                
-                if (ppu->ty < ty || ppu->ty >= ty + spriteHeight) {
-                    continue;
-                }
                 assert(ppu->ty >= ty && ppu->ty < ty + spriteHeight);
                 
                 uint8_t indexNumber = ppu->oam[baseIndex + 1];
@@ -842,44 +1228,29 @@ void INesPPUTick(INesInstance* instance) {
                 if (instance->ppu->sps) {
                     readAddr = ((indexNumber & 1) << 12) + ((uint16_t)(indexNumber >> 1) << 5) + by + (by & 8) ;
                 }
-                uint8_t byte0 = INesInstancePPURead(instance, readAddr);
-                uint8_t byte1 = INesInstancePPURead(instance, readAddr + 8);
-                uint8_t findSpr = 0;
+                // 水平翻转的精灵直接使用缓存中翻转后的像素，第 bx 个像素总是输出到 tx + bx
+                uint8_t patternBuffer[8];
+                const uint8_t* pattern = INesPPUGetPatternRow<Mapper>(instance, readAddr, attributeFlipHorz, patternBuffer);
+                // 这个精灵的 3 种不透明颜色
+                const uint8_t* colors = instance->ppu->palette + 0x10 + (attributeHigherColorBit << 2);
+                uint8_t spz = (spriteIndex == 0) ? 1 : 0;
+                if (spz) {
+                    ppu->spriteZeroInLine = true;
+                }
+                uint8_t flags = (attributeHigherColorBit << 2) | (attributeBgPriority << 4) | (spz << 5);
 
                 for (uint8_t bx = 0; bx < 8; ++bx) {
                     uint16_t x = (uint16_t)tx + (uint16_t)bx;
-                    if (attributeFlipHorz) {
-                        x = (uint16_t)tx + (uint16_t)(7 - bx);
-                    }
                     if (x >= 256) {
-                        continue;
-                    }
-                    findSpr = 1;
-                    
-                    uint8_t bit0 = (byte0 >> (7 - bx)) & 1;
-                    uint8_t bit1 = (byte1 >> (7 - bx)) & 1;
-                    uint8_t attributeLower = bit0 | (bit1 << 1);
-                    uint8_t attributeFull = attributeLower | (attributeHigherColorBit << 2);
-                    if (attributeLower == 0) {
-                        attributeFull = 0;
-                    }
-                    uint8_t paletteValue = INesInstancePPURead(instance, 0x3f10 + (uint16_t)attributeFull);
-                    uint8_t spz = (spriteIndex == 0) ? 1 : 0;
-                    if (attributeFull && !(ppu->spr_p[ppu->ty+1][x]&0x0f) && spriteCount < 8) {
-                        ppu->spr_p[ppu->ty+1][x] = attributeFull | (attributeBgPriority << 4) | (spz << 5);
-                        ppu->spr_d[ppu->ty+1][x] = paletteValue;
-                    }
-                }
-                
-                if (findSpr) {
-                    ++spriteCount;
-                    if (spriteCount == 9) {
-                        // overflow
-                        ppu->ovf = 1;
                         break;
                     }
+                    uint8_t attributeLower = pattern[bx];
+                    if (attributeLower && !(ppu->spr_p[x]&0x0f)) {
+                        ppu->spr_p[x] = attributeLower | flags;
+                        ppu->spr_d[x] = colors[attributeLower];
+                    }
                 }
-            } // end spriteIndex loop
+            } // end spriteSlot loop
         }
 
         if (ppu->ty <= 239 || ppu->ty == 261) {
@@ -899,10 +1270,8 @@ void INesPPUTick(INesInstance* instance) {
         if (ppu->ty == 261 && ppu->tx >= 280 && ppu->tx <= 304) {
             INesPPUCopyVertTToV(instance);
         }
-    } else {
-        if (ppu->ty <= 239 && ppu->tx <= 255) {
-            ppu->output[ppu->ty][ppu->tx] = INesInstancePPURead(instance, 0x3f00 + 0) & 0x3f;
-        }
+    } else if (ppu->ty <= 239 && ppu->tx == 255) {
+        INesPPURenderDots<Mapper>(instance, 256);
     }
     
     if (ppu->tx == 1) {
@@ -929,7 +1298,41 @@ void INesPPUTick(INesInstance* instance) {
         }
     }
     
-    INesInstanceOnPPUTick(instance);
+    if (Mapper::hasPPUTick) {
+        Mapper::PPUTick(instance);
+    }
+    ppu->idleUntil = INesPPUGetIdleUntil<Mapper>(instance);
+}
+
+/*
+ * 函数: INesPPURunMapper
+ * ----------------------
+ * 执行 pendingDots 中所有的点，idleUntil 之前的点一次推进，其余的点逐点执行 INesPPUTickMapper 。
+ * 执行完之后重新计算 deadline 。
+ *
+ * 参数 1 instance: Nes 实例
+ *
+ * 返回: 空
+ */
+template <typename Mapper>
+void INesPPURunMapper(INesInstance* instance) {
+    INesPPU* ppu = instance->ppu;
+    uint32_t pending = ppu->pendingDots;
+    while (pending > 0) {
+        if (ppu->tx < ppu->idleUntil) {
+            uint32_t count = ppu->idleUntil - ppu->tx;
+            if (count > pending) {
+                count = pending;
+            }
+            ppu->tx += count;
+            pending -= count;
+        } else {
+            INesPPUTickMapper<Mapper>(instance);
+            --pending;
+        }
+    }
+    ppu->pendingDots = 0;
+    ppu->deadline = INesPPUGetDeadline<Mapper>(instance);
 }
 
 uint8_t INesPPUIsRendering(INesInstance* instance) {
@@ -1000,6 +1403,7 @@ static uint16_t INesPPUGetSprPatternBaseAddr(INesInstance* instance) {
     return instance->ppu->spt ? 0x1000 : 0x0000;
 }
 
+template <typename Mapper>
 static void INesPPUFillBgRegister(INesInstance* instance) {
     // 获取 tile 中的 y 像素偏移（fine y）备用
     uint16_t fineY = (uint16_t)INesPPUGetFineY(instance);
@@ -1011,21 +1415,21 @@ static void INesPPUFillBgRegister(INesInstance* instance) {
     // 步骤 2: 通过 nametable 得到对应的值后，该值就是 patterntable 里的 tile 索引。
     // 由于 patterntable 里每个 tile 信息占了 16 字节，所以索引位置要乘以 16 来定位，即左移 4 。
     
-    uint16_t currTilePatternAddrOffset = (uint16_t)INesInstancePPURead(instance, currTileNameTableAddr) << 4;
+    uint16_t currTilePatternAddrOffset = (uint16_t)INesInstancePPUReadMapper<Mapper>(instance, currTileNameTableAddr) << 4;
     // 步骤 3: patterntable 索引作为偏移，加上 patterntable 基地址，就是要寻址的 patterntable tile 的起始地址。
     uint16_t currTilePatternAddr = patternSelectAddr + currTilePatternAddrOffset;
     // 步骤 4: 当前 tile 的 patterntable 基地址，加上 fine y 像素偏移，就可以得到 当前 fine y 下 8 个像素的图案值。
-    uint8_t patternValueCurr1 = INesInstancePPURead(instance, currTilePatternAddr + fineY);
+    uint8_t patternValueCurr1 = INesInstancePPUReadMapper<Mapper>(instance, currTilePatternAddr + fineY);
     // 步骤 5：同 4 步骤，不过这次获得的是像素对应的另外 1 位。
-    uint8_t patternValueCurr2 = INesInstancePPURead(instance, currTilePatternAddr + fineY + 8);
+    uint8_t patternValueCurr2 = INesInstancePPUReadMapper<Mapper>(instance, currTilePatternAddr + fineY + 8);
     
     // 和上面步骤类似，只是获取的是下一个 tile 的图案数据。
     uint16_t nextv = INesPPUGetVRAMByCoarseXInc(instance->ppu->v);
     uint16_t nextTileNameTableAddr = INesPPUGetNameTableAddr(nextv);
-    uint16_t nextTilePatternAddrOffset = (uint16_t)INesInstancePPURead(instance, nextTileNameTableAddr) << 4;
+    uint16_t nextTilePatternAddrOffset = (uint16_t)INesInstancePPUReadMapper<Mapper>(instance, nextTileNameTableAddr) << 4;
     uint16_t nextTilePatternAddr = patternSelectAddr + nextTilePatternAddrOffset;
-    uint8_t patternValueNext1 = INesInstancePPURead(instance, nextTilePatternAddr + fineY);
-    uint8_t patternValueNext2 = INesInstancePPURead(instance, nextTilePatternAddr + fineY + 8);
+    uint8_t patternValueNext1 = INesInstancePPUReadMapper<Mapper>(instance, nextTilePatternAddr + fineY);
+    uint8_t patternValueNext2 = INesInstancePPUReadMapper<Mapper>(instance, nextTilePatternAddr + fineY + 8);
     
     // 组合当前和下一个 tile 的图案数据到两个 16 位位移寄存器。
     instance->ppu->bgs16[0] = (uint16_t)patternValueNext1 | ((uint16_t)patternValueCurr1 << 8);
@@ -1035,7 +1439,7 @@ static void INesPPUFillBgRegister(INesInstance* instance) {
     // 步骤 1: 获取当前 tile 的属性表地址。
     uint16_t currAttrAddr = INesPPUGetAttributeTableAddr(instance->ppu->v);
     // 步骤 2: 通过属性表地址获得对应的属性数值。
-    uint8_t currAttrData = INesInstancePPURead(instance, currAttrAddr);
+    uint8_t currAttrData = INesInstancePPUReadMapper<Mapper>(instance, currAttrAddr);
     // 步骤 3: 重要！计算方格内部偏移量。
     uint8_t currFineTile = ((instance->ppu->v & 2) >> 1) | ((instance->ppu->v & 0x40) >> 5);
     // 步骤 4: 计算属性比特值的低 1 位。
@@ -1048,7 +1452,7 @@ static void INesPPUFillBgRegister(INesInstance* instance) {
     
     // 用同样的步骤获取下一个 tile 对应的属性值，写到 1 位寄存器上作为候补填充。
     uint16_t nextAttrAddr = INesPPUGetAttributeTableAddr(nextv);
-    uint8_t nextAttrData = INesInstancePPURead(instance, nextAttrAddr);
+    uint8_t nextAttrData = INesInstancePPUReadMapper<Mapper>(instance, nextAttrAddr);
     uint8_t nextFineTile = ((nextv & 2)>> 1) | ((nextv & 0x40) >> 5);
     instance->ppu->bgb8[0] = 1 & (nextAttrData >> (nextFineTile << 1));
     instance->ppu->bgb8[1] = 1 & (nextAttrData >> ((nextFineTile << 1) + 1));
@@ -1058,3 +1462,14 @@ static void INesPPUIncreaseVRAM(INesInstance* instance) {
     INesPPU* ppu = instance->ppu;
     ppu->v = (ppu->v + (ppu->vac ? 32 : 1)) & 0x7fff;
 }
+
+#define INES_PPU_TICK_INSTANTIATE(Mapper) \
+    template void INesPPURunMapper<Mapper>(INesInstance* instance); \
+    template void INesPPUCatchUpMapper<Mapper>(INesInstance* instance, bool write);
+INES_MAPPER_TRAITS_LIST(INES_PPU_TICK_INSTANTIATE)
+#undef INES_PPU_TICK_INSTANTIATE
+
+void INesPPUTick(INesInstance* instance) {
+    INesPPUAddDots(instance->ppu, 1);
+    INesPPURunMapper<INesMapperTraitsDynamic>(instance);
+}
@@ -60,17 +60,30 @@ struct INesPPU {
     uint8_t oam[256];       // OAM memory
     uint8_t oam2[32];       // secondary OAM memory
     uint8_t mem[0x4000];    // PPU memory
+    uint8_t palette[32];    // 渲染用的 $3F00-$3F1F 颜色，已处理镜像和灰度，见 INesPPUUpdatePalette
     
     // output
-    uint8_t bg_p[240][256];
-    uint8_t bg_d[240][256];
-    uint8_t spr_p[240][256];
-    uint8_t spr_d[240][256];
+    // 只保存一行：背景在渲染当前行时生成并立即合成；精灵在上一行的点 256 求值后写入，渲染这一行时取出并清空
+    uint8_t bg_p[256];
+    uint8_t bg_d[256];
+    uint8_t spr_p[256];
+    uint8_t spr_d[256];
     uint8_t output[240][256];
     
+    // 按扫描线分组的精灵编号，每行按 OAM 顺序最多 9 个，第 9 个只用于设置溢出标志
+    uint8_t spriteLists[240][9];
+    uint8_t spriteListCount[240];
+    bool spriteListsDirty;  // OAM 或精灵大小变化后为 true，下一次求值精灵时重建
+    
     // help
     long long tick;
     bool fetchSprite;
+    uint16_t renderedDot;   // 当前可视扫描线已经渲染到的点，见 INesPPUCatchUp
+    uint16_t idleUntil;     // 当前扫描线上 tx 小于它的点没有任何作用，只需要递增 tx ，见 INesPPUGetIdleUntil
+    uint32_t pendingDots;   // CPU 侧已经经过、PPU 还没有执行的点数，见 INesPPUAddDots
+    uint32_t deadline;      // pendingDots 达到它时 CPU 可能通过中断观察到 PPU，必须先执行，见 INesPPUGetDeadline
+    bool skipFrame;         // 在预渲染扫描线开始时从 instance->renderSkip 取得，整帧不变
+    bool spriteZeroInLine;  // 0 号精灵在当前扫描线上，跳过渲染时这一行仍需要计算 sprite 0 hit
 };
 
 /*
@@ -100,6 +113,18 @@ void INesPPUGetColorByPalleteIndex(uint8_t index, uint8_t* r, uint8_t* g, uint8_
  */
 uint8_t INesPPUReadPort(INesInstance* instance, uint16_t addr);
 
+/*
+ * 函数: INesPPUPeekStatus
+ * -----------------------
+ * 返回此时读取 $2002(PPUSTATUS) 将得到的值，但不产生读取的副作用（清除 VBlank 位和切换位）。
+ * 供 CPU 判断空转循环读取的结果是否变化。
+ *
+ * 参数 1 instance: Nes 实例
+ *
+ * 返回: 8 位 PPUSTATUS 数值。
+ */
+uint8_t INesPPUPeekStatus(INesInstance* instance);
+
 /*
  * 函数: INesPPUWritePort
  * ------------------
@@ -125,15 +150,74 @@ void INesPPUWritePort(INesInstance* instance, uint16_t addr, uint8_t data);
  */
 void INesPPUReset(INesInstance* instance);
 
+/*
+ * 函数: INesPPUUpdatePalette
+ * --------------------------
+ * 从 PPU 内存的 $3F00-$3F1F 重新计算 palette，渲染时直接用调色板索引读取，不再经过 PPU 地址映射。
+ * 下标为 4 的倍数的项与 INesInstancePPURead 一致，都取 $3F00 的背景色。
+ * 颜色只保留低 6 位，PPUMASK 的灰度位为 1 时再只保留高 2 位；强调位不改变颜色索引，不在这里处理。
+ * 写入 $3F00-$3FFF、写入 PPUMASK 以及重置时调用。
+ *
+ * 参数 1 instance: Nes 实例
+ *
+ * 返回: 空
+ */
+void INesPPUUpdatePalette(INesInstance* instance);
+
 /*
  * 函数: INesPPUTick
  * -----------------
- * 执行一次 PPU 时钟
+ * 执行一次 PPU 时钟，mapper 的 CHR 读取和 PPU 时钟回调通过函数表分发。
+ * 主循环使用按 mapper 实例化的 INesPPURunMapper（见 iNesMapperTraits.hpp）。
  *
  * 返回: 空
  */
 void INesPPUTick(INesInstance* instance);
 
+/*
+ * 函数: INesPPUAddDots
+ * --------------------
+ * CPU 侧推进 count 个 PPU 时钟。PPU 不立即执行这些点，只累加到 pendingDots 中，
+ * 等到 CPU 访问 PPU 端口或 mapper、到达 deadline 或者一帧结束时由 INesPPURunMapper 一起执行。
+ * tick 在这里递增，始终是 CPU 侧的时钟，主循环用它对齐 CPU 时钟。
+ *
+ * 参数 1 ppu: PPU
+ * 参数 2 count: 点数
+ *
+ * 返回: true 表示已经到达 deadline，CPU 执行这个时钟之前需要先执行 INesPPURunMapper
+ */
+static inline bool INesPPUAddDots(INesPPU* ppu, uint32_t count) {
+    ppu->tick += count;
+    ppu->pendingDots += count;
+    return ppu->pendingDots >= ppu->deadline;
+}
+
+/*
+ * 函数: INesPPUCatchUp
+ * --------------------
+ * 可视扫描线上的点在 INesPPUTick 中推迟到一行的最后整行渲染。
+ * CPU 写入 PPU 寄存器、读取 PPUDATA 或者写入 mapper 之前调用。
+ * 先执行 pendingDots 中的点，再按写入之前的状态渲染这一行已经经过的点，
+ * 之后的点按写入后的状态渲染，结果与逐点渲染一致。
+ *
+ * 参数 1 instance: Nes 实例
+ *
+ * 返回: 空
+ */
+void INesPPUCatchUp(INesInstance* instance);
+
+/*
+ * 函数: INesPPUSync
+ * -----------------
+ * CPU 读取其它 PPU 寄存器或者 mapper 之前调用，只执行 pendingDots 中的点。
+ * 读取不改变渲染状态，只有 0 号精灵在当前行上并且还没有 hit 时才需要渲染到当前的点，得到正确的 s0h 。
+ *
+ * 参数 1 instance: Nes 实例
+ *
+ * 返回: 空
+ */
+void INesPPUSync(INesInstance* instance);
+
 /*
  * 函数: INesPPUIsRendering
  * ------------------------
@@ -0,0 +1,164 @@
+#include "iNesPPUComposite.hpp"
+
+#if NES_PPU_SIMD && defined(__SSE2__)
+#define INES_PPU_COMPOSITE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// AVX2 版本用 target 属性单独编译，运行时检测 CPU 后选择，不需要整个工程打开 -mavx2
+#if NES_PPU_SIMD && defined(__x86_64__) && (defined(__clang__) || defined(__GNUC__))
+#define INES_PPU_COMPOSITE_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if !INES_PPU_COMPOSITE_SSE2
+static int INesPPUCompositeLineScalar(const INesPPU* ppu, uint8_t* output, const uint8_t* bgPalette, const uint8_t* bgColor,
+                                      const uint8_t* sprPalette, const uint8_t* sprColor, uint8_t backdrop) {
+    int hitX = -1;
+    for (uint16_t x = 0; x < 256; ++x) {
+        bool hit = false;
+        output[x] = INesPPUCompositePixel(ppu, x, bgPalette[x], bgColor[x], sprPalette[x], sprColor[x], backdrop, &hit);
+        if (hit && hitX < 0) {
+            hitX = x;
+        }
+    }
+    return hitX;
+}
+#endif
+
+#if INES_PPU_COMPOSITE_SSE2
+// 合成 16 个像素，返回发生 sprite 0 hit 的像素位掩码
+static inline int INesPPUCompositeChunkSSE2(__m128i bgMask, __m128i sprMask, __m128i back, uint8_t* output, const uint8_t* bgPalette,
+                                            const uint8_t* bgColor, const uint8_t* sprPalette, const uint8_t* sprColor) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi8(-1);
+    const __m128i paletteBits = _mm_set1_epi8(0x0f);
+    const __m128i priorityBit = _mm_set1_epi8(0x10);
+    const __m128i zeroSpriteBit = _mm_set1_epi8(0x20);
+    __m128i bp = _mm_loadu_si128((const __m128i*)bgPalette);
+    __m128i bc = _mm_loadu_si128((const __m128i*)bgColor);
+    __m128i sp = _mm_loadu_si128((const __m128i*)sprPalette);
+    __m128i sc = _mm_loadu_si128((const __m128i*)sprColor);
+    __m128i bgVisible = _mm_andnot_si128(_mm_cmpeq_epi8(bp, zero), bgMask);
+    __m128i sprVisible = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_and_si128(sp, paletteBits), zero), sprMask);
+    __m128i sprFront = _mm_cmpeq_epi8(_mm_and_si128(sp, priorityBit), zero);
+    __m128i useSpr = _mm_and_si128(sprVisible, _mm_or_si128(sprFront, _mm_andnot_si128(bgVisible, ones)));
+    __m128i bgOut = _mm_or_si128(_mm_and_si128(bgVisible, bc), _mm_andnot_si128(bgVisible, back));
+    _mm_storeu_si128((__m128i*)output, _mm_or_si128(_mm_and_si128(useSpr, sc), _mm_andnot_si128(useSpr, bgOut)));
+    __m128i zeroSprite = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_and_si128(sp, zeroSpriteBit), zero), ones);
+    return _mm_movemask_epi8(_mm_and_si128(zeroSprite, _mm_and_si128(bgVisible, sprVisible)));
+}
+
+static int INesPPUCompositeLineSSE2(const INesPPU* ppu, uint8_t* output, const uint8_t* bgPalette, const uint8_t* bgColor,
+                                    const uint8_t* sprPalette, const uint8_t* sprColor, uint8_t backdrop) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi8(-1);
+    const __m128i back = _mm_set1_epi8((char)backdrop);
+    const __m128i right = _mm_set_epi64x(-1, 0);    // x >= 8 的 8 个像素
+    const __m128i bgEnable = ppu->bge ? ones : zero;
+    const __m128i sprEnable = ppu->spe ? ones : zero;
+    int hitX = -1;
+    for (int x = 0; x < 256; x += 16) {
+        __m128i bgMask = bgEnable;
+        __m128i sprMask = sprEnable;
+        if (x == 0) {
+            bgMask = ppu->bl8 ? bgMask : _mm_and_si128(bgMask, right);
+            sprMask = ppu->sl8 ? sprMask : _mm_and_si128(sprMask, right);
+        }
+        int hits = INesPPUCompositeChunkSSE2(bgMask, sprMask, back, output + x, bgPalette + x, bgColor + x, sprPalette + x, sprColor + x);
+        if (hits && hitX < 0) {
+            hitX = x + __builtin_ctz((unsigned)hits);
+        }
+    }
+    return hitX;
+}
+#endif
+
+#if INES_PPU_COMPOSITE_AVX2
+__attribute__((target("avx2")))
+static int INesPPUCompositeLineAVX2(const INesPPU* ppu, uint8_t* output, const uint8_t* bgPalette, const uint8_t* bgColor,
+                                    const uint8_t* sprPalette, const uint8_t* sprColor, uint8_t backdrop) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi8(-1);
+    const __m256i paletteBits = _mm256_set1_epi8(0x0f);
+    const __m256i priorityBit = _mm256_set1_epi8(0x10);
+    const __m256i zeroSpriteBit = _mm256_set1_epi8(0x20);
+    const __m256i back = _mm256_set1_epi8((char)backdrop);
+    const __m256i right = _mm256_set_epi64x(-1, -1, -1, 0);
+    const __m256i bgEnable = ppu->bge ? ones : zero;
+    const __m256i sprEnable = ppu->spe ? ones : zero;
+    int hitX = -1;
+    for (int x = 0; x < 256; x += 32) {
+        __m256i bgMask = bgEnable;
+        __m256i sprMask = sprEnable;
+        if (x == 0) {
+            bgMask = ppu->bl8 ? bgMask : _mm256_and_si256(bgMask, right);
+            sprMask = ppu->sl8 ? sprMask : _mm256_and_si256(sprMask, right);
+        }
+        __m256i bp = _mm256_loadu_si256((const __m256i*)(bgPalette + x));
+        __m256i bc = _mm256_loadu_si256((const __m256i*)(bgColor + x));
+        __m256i sp = _mm256_loadu_si256((const __m256i*)(sprPalette + x));
+        __m256i sc = _mm256_loadu_si256((const __m256i*)(sprColor + x));
+        __m256i bgVisible = _mm256_andnot_si256(_mm256_cmpeq_epi8(bp, zero), bgMask);
+        __m256i sprVisible = _mm256_andnot_si256(_mm256_cmpeq_epi8(_mm256_and_si256(sp, paletteBits), zero), sprMask);
+        __m256i sprFront = _mm256_cmpeq_epi8(_mm256_and_si256(sp, priorityBit), zero);
+        __m256i useSpr = _mm256_and_si256(sprVisible, _mm256_or_si256(sprFront, _mm256_andnot_si256(bgVisible, ones)));
+        __m256i bgOut = _mm256_blendv_epi8(back, bc, bgVisible);
+        _mm256_storeu_si256((__m256i*)(output + x), _mm256_blendv_epi8(bgOut, sc, useSpr));
+        if (hitX < 0) {
+            __m256i zeroSprite = _mm256_andnot_si256(_mm256_cmpeq_epi8(_mm256_and_si256(sp, zeroSpriteBit), zero), ones);
+            unsigned hits = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(zeroSprite, _mm256_and_si256(bgVisible, sprVisible)));
+            if (hits) {
+                hitX = x + __builtin_ctz(hits);
+            }
+        }
+    }
+    return hitX;
+}
+#endif
+
+typedef int (*INesPPUCompositeLineFunc)(const INesPPU* ppu, uint8_t* output, const uint8_t* bgPalette, const uint8_t* bgColor,
+                                        const uint8_t* sprPalette, const uint8_t* sprColor, uint8_t backdrop);
+
+static INesPPUCompositeLineFunc INesPPUSelectCompositeLine() {
+#if INES_PPU_COMPOSITE_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return INesPPUCompositeLineAVX2;
+    }
+#endif
+#if INES_PPU_COMPOSITE_SSE2
+    return INesPPUCompositeLineSSE2;
+#else
+    return INesPPUCompositeLineScalar;
+#endif
+}
+
+int INesPPUCompositeLine(const INesPPU* ppu, uint8_t* output, const uint8_t* bgPalette, const uint8_t* bgColor,
+                         const uint8_t* sprPalette, const uint8_t* sprColor, uint8_t backdrop) {
+    static const INesPPUCompositeLineFunc func = INesPPUSelectCompositeLine();
+    return func(ppu, output, bgPalette, bgColor, sprPalette, sprColor, backdrop);
+}
+
+bool INesPPUCompositeSpan(const INesPPU* ppu, uint16_t begin, uint16_t end, uint8_t* output, const uint8_t* bgPalette,
+                          const uint8_t* bgColor, const uint8_t* sprPalette, const uint8_t* sprColor, uint8_t backdrop) {
+    bool hit = false;
+    uint16_t x = begin;
+#if INES_PPU_COMPOSITE_SSE2
+    // 最左边 8 个像素受 bl8/sl8 影响，逐像素合成，之后每次 16 个
+    for (; x < end && x < 8; ++x) {
+        output[x] = INesPPUCompositePixel(ppu, x, bgPalette[x], bgColor[x], sprPalette[x], sprColor[x], backdrop, &hit);
+    }
+    const __m128i bgMask = ppu->bge ? _mm_set1_epi8(-1) : _mm_setzero_si128();
+    const __m128i sprMask = ppu->spe ? _mm_set1_epi8(-1) : _mm_setzero_si128();
+    const __m128i back = _mm_set1_epi8((char)backdrop);
+    for (; x + 16 <= end; x += 16) {
+        if (INesPPUCompositeChunkSSE2(bgMask, sprMask, back, output + x, bgPalette + x, bgColor + x, sprPalette + x, sprColor + x)) {
+            hit = true;
+        }
+    }
+#endif
+    for (; x < end; ++x) {
+        output[x] = INesPPUCompositePixel(ppu, x, bgPalette[x], bgColor[x], sprPalette[x], sprColor[x], backdrop, &hit);
+    }
+    return hit;
+}
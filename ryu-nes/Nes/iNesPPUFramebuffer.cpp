@@ -0,0 +1,130 @@
+#include "iNesPPUFramebuffer.hpp"
+#include "iNesPPUComposite.hpp"
+#include <stdlib.h>
+#include <string.h>
+
+// 与 iNesPPUComposite.cpp 相同，AVX2 版本用 target 属性单独编译，运行时检测 CPU 后选择
+#if NES_PPU_SIMD && defined(__x86_64__) && (defined(__clang__) || defined(__GNUC__))
+#define INES_PPU_FRAMEBUFFER_AVX2 1
+#include <immintrin.h>
+#endif
+
+static uint32_t INesPPUFramebufferPackPixel(enum INesPPUPixelFormat format, uint8_t r, uint8_t g, uint8_t b) {
+    switch (format) {
+        case INesPPUPixelFormatRGB565:
+            return ((uint32_t)(r >> 3) << 11) | ((uint32_t)(g >> 2) << 5) | (b >> 3);
+        case INesPPUPixelFormatRGBA8888: {
+            uint8_t bytes[4] = { r, g, b, 0xff };
+            uint32_t pixel;
+            memcpy(&pixel, bytes, sizeof(pixel));
+            return pixel;
+        }
+        case INesPPUPixelFormatARGB8888:
+        default:
+            return 0xff000000 | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    }
+}
+
+static void INesPPUFramebufferBuildLUT(INesPPUFramebuffer* framebuffer) {
+    for (uint16_t i = 0; i < 512; ++i) {
+        uint8_t emphasis = i >> 6;
+        uint8_t rgb[3];
+        INesPPUGetColorByPalleteIndex(i & 0x3f, &rgb[0], &rgb[1], &rgb[2]);
+        // 有强调位时，没有被强调的颜色分量衰减到约 3/4
+        if (emphasis) {
+            for (uint8_t c = 0; c < 3; ++c) {
+                if (!((emphasis >> c) & 1)) {
+                    rgb[c] = (uint8_t)(rgb[c] * 191 / 255);
+                }
+            }
+        }
+        framebuffer->lut[i] = INesPPUFramebufferPackPixel(framebuffer->format, rgb[0], rgb[1], rgb[2]);
+    }
+}
+
+void INesPPUSetFramebuffer(INesInstance* instance, void* pixels, size_t pitch, enum INesPPUPixelFormat format) {
+    // 推迟执行的点属于之前的 pixels
+    INesPPUSync(instance);
+    INesPPUFramebuffer* framebuffer = instance->framebuffer;
+    if (!framebuffer) {
+        if (!pixels) {
+            return;
+        }
+        framebuffer = (INesPPUFramebuffer*)malloc(sizeof(INesPPUFramebuffer));
+        memset(framebuffer, 0, sizeof(INesPPUFramebuffer));
+        framebuffer->format = format;
+        INesPPUFramebufferBuildLUT(framebuffer);
+        instance->framebuffer = framebuffer;
+    } else if (framebuffer->format != format) {
+        framebuffer->format = format;
+        INesPPUFramebufferBuildLUT(framebuffer);
+    }
+    framebuffer->pixels = pixels;
+    framebuffer->pitch = pitch;
+    framebuffer->bytesPerPixel = (format == INesPPUPixelFormatRGB565) ? 2 : 4;
+}
+
+void INesPPUFramebufferDestroy(INesInstance* instance) {
+    if (instance->framebuffer) {
+        free(instance->framebuffer);
+        instance->framebuffer = NULL;
+    }
+}
+
+static void INesPPUFramebufferConvertLineScalar(const uint32_t* lut, const uint8_t* indices, void* pixels, uint8_t bytesPerPixel) {
+    if (bytesPerPixel == 2) {
+        uint16_t* row = (uint16_t*)pixels;
+        for (uint16_t x = 0; x < 256; ++x) {
+            row[x] = (uint16_t)lut[indices[x] & 0x3f];
+        }
+    } else {
+        uint32_t* row = (uint32_t*)pixels;
+        for (uint16_t x = 0; x < 256; ++x) {
+            row[x] = lut[indices[x] & 0x3f];
+        }
+    }
+}
+
+#if INES_PPU_FRAMEBUFFER_AVX2
+// 每次取 16 个颜色索引，分两次 gather 出 8 个 32 位像素；RGB565 再压缩成 16 位
+__attribute__((target("avx2")))
+static void INesPPUFramebufferConvertLineAVX2(const uint32_t* lut, const uint8_t* indices, void* pixels, uint8_t bytesPerPixel) {
+    const __m128i colorBits = _mm_set1_epi8(0x3f);
+    for (int x = 0; x < 256; x += 16) {
+        __m128i index = _mm_and_si128(_mm_loadu_si128((const __m128i*)(indices + x)), colorBits);
+        __m256i lo = _mm256_i32gather_epi32((const int*)lut, _mm256_cvtepu8_epi32(index), 4);
+        __m256i hi = _mm256_i32gather_epi32((const int*)lut, _mm256_cvtepu8_epi32(_mm_srli_si128(index, 8)), 4);
+        if (bytesPerPixel == 2) {
+            // packus 按 128 位分别交错两个输入，需要再调整 64 位块的顺序
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_storeu_si256((__m256i*)((uint16_t*)pixels + x), packed);
+        } else {
+            _mm256_storeu_si256((__m256i*)((uint32_t*)pixels + x), lo);
+            _mm256_storeu_si256((__m256i*)((uint32_t*)pixels + x + 8), hi);
+        }
+    }
+}
+#endif
+
+typedef void (*INesPPUFramebufferConvertLineFunc)(const uint32_t* lut, const uint8_t* indices, void* pixels, uint8_t bytesPerPixel);
+
+static INesPPUFramebufferConvertLineFunc INesPPUFramebufferSelectConvertLine() {
+#if INES_PPU_FRAMEBUFFER_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return INesPPUFramebufferConvertLineAVX2;
+    }
+#endif
+    return INesPPUFramebufferConvertLineScalar;
+}
+
+void INesPPUFramebufferWriteLine(INesInstance* instance, uint16_t y) {
+    static const INesPPUFramebufferConvertLineFunc func = INesPPUFramebufferSelectConvertLine();
+    INesPPUFramebuffer* framebuffer = instance->framebuffer;
+    if (!framebuffer || !framebuffer->pixels) {
+        return;
+    }
+    INesPPU* ppu = instance->ppu;
+    uint8_t emphasis = ppu->emr | (ppu->emg << 1) | (ppu->emb << 2);
+    uint8_t* row = (uint8_t*)framebuffer->pixels + framebuffer->pitch * y;
+    func(framebuffer->lut + (emphasis << 6), ppu->output[y], row, framebuffer->bytesPerPixel);
+}
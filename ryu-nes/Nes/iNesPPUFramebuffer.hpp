@@ -0,0 +1,63 @@
+#ifndef iNesPPUFramebuffer_hpp
+#define iNesPPUFramebuffer_hpp
+
+#include "iNesInstance.hpp"
+#include "iNesPPU.hpp"
+
+#include <stdio.h>
+#include <stdint.h>
+
+enum INesPPUPixelFormat {
+    INesPPUPixelFormatARGB8888 = 0,     // 32 位整数 0xAARRGGBB，与 SDL_PIXELFORMAT_ARGB8888 相同
+    INesPPUPixelFormatRGB565 = 1,       // 16 位整数 rrrrrggggggbbbbb
+    INesPPUPixelFormatRGBA8888 = 2,     // 按字节顺序 R G B A，与 SDL_PIXELFORMAT_RGBA32 相同
+};
+
+// 调用方提供的输出帧，PPU 每渲染完一条可视扫描线就把这一行转换后写入
+struct INesPPUFramebuffer {
+    void* pixels;               // 256x240 像素，为 NULL 时不输出
+    size_t pitch;               // 每行的字节数
+    enum INesPPUPixelFormat format;
+    uint8_t bytesPerPixel;
+    uint32_t lut[512];          // 下标为 (强调位 << 6) | 颜色索引，强调位 bit0~2 依次为 emr/emg/emb；RGB565 只使用低 16 位
+};
+
+/*
+ * 函数: INesPPUSetFramebuffer
+ * ---------------------------
+ * 设置输出帧，之后渲染的每一条可视扫描线都会写入 pixels 中对应的行。
+ * 一帧之中可以更换 pixels，从下一条渲染完成的扫描线开始写入新的 pixels 。
+ * ppu->output 仍然保存颜色索引，不设置输出帧时行为与之前一致。
+ *
+ * 参数 1 instance: Nes 实例
+ * 参数 2 pixels: 至少 240 行、每行 pitch 字节的内存，由调用方管理，传入 NULL 取消输出
+ * 参数 3 pitch: 每行的字节数
+ * 参数 4 format: 像素格式
+ *
+ * 返回: 空
+ */
+void INesPPUSetFramebuffer(INesInstance* instance, void* pixels, size_t pitch, enum INesPPUPixelFormat format);
+
+/*
+ * 函数: INesPPUFramebufferDestroy
+ * -------------------------------
+ * 参数 1 instance: Nes 实例
+ *
+ * 返回: 空
+ */
+void INesPPUFramebufferDestroy(INesInstance* instance);
+
+/*
+ * 函数: INesPPUFramebufferWriteLine
+ * ---------------------------------
+ * 把 ppu->output 中第 y 行的颜色索引按当前的强调位查表转换后写入输出帧。
+ * 灰度已经在 ppu->palette 中处理，这里只需要处理强调位。
+ *
+ * 参数 1 instance: Nes 实例
+ * 参数 2 y: 0~239
+ *
+ * 返回: 空
+ */
+void INesPPUFramebufferWriteLine(INesInstance* instance, uint16_t y);
+
+#endif /* iNesPPUFramebuffer_hpp */
@@ -0,0 +1,272 @@
+#include "iNesPPUThread.hpp"
+#include "iNesMapper.hpp"
+#include "iNesTileCache.hpp"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+void INesPPUThreadGrow(INesPPUThreadJob* job) {
+    job->capacity = job->capacity ? job->capacity * 2 : 1024;
+    job->entries = (INesPPUThreadEntry*)realloc(job->entries, sizeof(INesPPUThreadEntry) * job->capacity);
+}
+
+#if NES_PPU_THREAD
+// 复制 output 以外的部分，output 由各自的实例维护
+static void INesPPUThreadCopyPPU(INesPPU* dst, const INesPPU* src) {
+    size_t outputBegin = offsetof(INesPPU, output);
+    size_t outputEnd = outputBegin + sizeof(src->output);
+    memcpy(dst, src, outputBegin);
+    memcpy((uint8_t*)dst + outputEnd, (const uint8_t*)src + outputEnd, sizeof(INesPPU) - outputEnd);
+}
+
+/*
+ * 函数: INesPPUThreadApplySnapshot
+ * --------------------------------
+ * 把一帧开始时的快照应用到影子实例。CPU 线程跳过渲染，移位寄存器、精灵缓冲等渲染的中间结果不完整，
+ * 这些值保留影子实例自己的；影子实例重放了之前所有的访问，其余状态在这里与快照相同，覆盖只是为了不累积误差。
+ *
+ * 参数 1 shadow: 影子实例
+ * 参数 2 job: 快照所在的帧，其中的 ppu 会被修改
+ *
+ * 返回: 空
+ */
+static void INesPPUThreadApplySnapshot(INesInstance* shadow, INesPPUThreadJob* job) {
+    INesPPU* ppu = shadow->ppu;
+    INesPPU* snapshot = &job->ppu;
+    memcpy(snapshot->bgs16, ppu->bgs16, sizeof(ppu->bgs16));
+    memcpy(snapshot->bgs8, ppu->bgs8, sizeof(ppu->bgs8));
+    memcpy(snapshot->bgb8, ppu->bgb8, sizeof(ppu->bgb8));
+    memcpy(snapshot->bg_p, ppu->bg_p, sizeof(ppu->bg_p));
+    memcpy(snapshot->bg_d, ppu->bg_d, sizeof(ppu->bg_d));
+    memcpy(snapshot->spr_p, ppu->spr_p, sizeof(ppu->spr_p));
+    memcpy(snapshot->spr_d, ppu->spr_d, sizeof(ppu->spr_d));
+    snapshot->renderedDot = ppu->renderedDot;
+    snapshot->skipFrame = ppu->skipFrame;
+    snapshot->spriteZeroInLine = ppu->spriteZeroInLine;
+    snapshot->idleUntil = 0;
+    INesPPUThreadCopyPPU(ppu, snapshot);
+
+    if (shadow->mapper->dataSize) {
+        memcpy(shadow->mapper->data, job->mapperData, shadow->mapper->dataSize);
+    }
+    shadow->mirror = job->mirror;
+    shadow->renderSkip = job->renderSkip;
+    // CHR RAM 的内容来自快照，对应的 tile 重新解码
+    INesTileCache* cache = shadow->tileCache;
+    uint32_t firstRAMTile = (uint32_t)(shadow->file->CHRRomSize >> 4);
+    memset(cache->valid + firstRAMTile, 0, cache->tileCount - firstRAMTile);
+    INesTileCacheUpdatePages(shadow);
+    INesPPUSetFramebuffer(shadow, job->pixels, job->pitch, job->format);
+}
+
+// 影子实例的 PPU 执行到这一帧开始后的第 dot 个时钟
+static void INesPPUThreadRunTo(INesInstance* shadow, const INesPPUThreadJob* job, uint32_t dot) {
+    long long target = job->startTick + dot;
+    if (target > shadow->ppu->tick) {
+        INesPPUAddDots(shadow->ppu, (uint32_t)(target - shadow->ppu->tick));
+        INesPPUSync(shadow);
+    }
+}
+
+static void INesPPUThreadReplay(INesInstance* shadow, INesPPUThreadJob* job) {
+    INesPPUThreadApplySnapshot(shadow, job);
+    for (size_t i = 0; i < job->count; ++i) {
+        const INesPPUThreadEntry* entry = &job->entries[i];
+        INesPPUThreadRunTo(shadow, job, entry->dot);
+        switch ((INesPPUThreadEntryType)entry->type) {
+            case INesPPUThreadEntryWrite:
+                INesPPUWritePort(shadow, entry->addr, entry->data);
+                break;
+            case INesPPUThreadEntryRead:
+                INesPPUReadPort(shadow, entry->addr);
+                break;
+            case INesPPUThreadEntryMapperWrite:
+                INesPPUCatchUp(shadow);
+                INesMapperWrite(shadow, entry->addr, entry->data);
+                break;
+        }
+    }
+    INesPPUThreadRunTo(shadow, job, job->endDot);
+}
+
+static void INesPPUThreadMain(INesPPUThread* thread) {
+    std::unique_lock<std::mutex> lock(thread->mutex);
+    while (true) {
+        thread->cond.wait(lock, [thread] { return thread->submitted || !thread->running; });
+        if (!thread->submitted) {
+            break;
+        }
+        INesPPUThreadJob* job = thread->submitted;
+        lock.unlock();
+        INesPPUThreadReplay(thread->shadow, job);
+        lock.lock();
+        thread->submitted = NULL;
+        thread->cond.notify_all();
+    }
+}
+
+// 等待后台线程空闲，然后把影子实例的 output 复制给 CPU 线程的实例
+static void INesPPUThreadWait(INesInstance* instance) {
+    INesPPUThread* thread = instance->renderThread;
+    std::unique_lock<std::mutex> lock(thread->mutex);
+    thread->cond.wait(lock, [thread] { return !thread->submitted; });
+    memcpy(instance->ppu->output, thread->shadow->ppu->output, sizeof(instance->ppu->output));
+}
+
+/*
+ * 函数: INesPPUThreadCreateShadow
+ * -------------------------------
+ * 创建只用于渲染的影子实例，PPU、mapper 与 CPU 线程的实例当前状态相同。
+ * PRG ROM、PRG RAM 等与 CPU 线程共用，重放时不会写入；MMC3 等会把 CHR 写入 file->CHRRom，所以 CHR 使用单独的一份。
+ * CPU 只用于接收 mapper 产生的 IRQ，APU 和手柄不会用到。
+ *
+ * 参数 1 instance: Nes 实例
+ *
+ * 返回: 影子实例
+ */
+static INesInstance* INesPPUThreadCreateShadow(INesInstance* instance) {
+    INesInstance* shadow = (INesInstance*)malloc(sizeof(INesInstance));
+    memcpy(shadow, instance, sizeof(INesInstance));
+
+    shadow->file = (INesFile*)malloc(sizeof(INesFile));
+    memcpy(shadow->file, instance->file, sizeof(INesFile));
+    if (instance->file->CHRRom) {
+        shadow->file->CHRRom = (uint8_t*)malloc(instance->file->CHRRomSize);
+        memcpy(shadow->file->CHRRom, instance->file->CHRRom, instance->file->CHRRomSize);
+    }
+
+    shadow->cpu = (CPU2A03*)malloc(sizeof(CPU2A03));
+    memset(shadow->cpu, 0, sizeof(CPU2A03));
+    shadow->pad = NULL;
+    shadow->apu = NULL;
+
+    shadow->ppu = (INesPPU*)malloc(sizeof(INesPPU));
+    memcpy(shadow->ppu, instance->ppu, sizeof(INesPPU));
+
+    shadow->mapper = (INesMapper*)malloc(sizeof(INesMapper));
+    memcpy(shadow->mapper, instance->mapper, sizeof(INesMapper));
+    if (instance->mapper->dataSize) {
+        shadow->mapper->data = malloc(instance->mapper->dataSize);
+        memcpy(shadow->mapper->data, instance->mapper->data, instance->mapper->dataSize);
+    }
+
+    INesTileCacheCreate(shadow);
+    INesTileCacheUpdatePages(shadow);
+    shadow->framebuffer = NULL;
+    shadow->renderThread = NULL;
+    shadow->renderSkip = false;
+    return shadow;
+}
+
+static void INesPPUThreadDestroyShadow(INesInstance* shadow) {
+    INesPPUFramebufferDestroy(shadow);
+    INesTileCacheDestroy(shadow);
+    INesMapperDestroy(shadow);
+    free(shadow->ppu);
+    free(shadow->cpu);
+    if (shadow->file->CHRRom) {
+        free(shadow->file->CHRRom);
+    }
+    free(shadow->file);
+    free(shadow);
+}
+#endif
+
+bool INesPPUThreadStart(INesInstance* instance) {
+#if NES_PPU_THREAD
+    if (instance->renderThread) {
+        return true;
+    }
+    INesPPUSync(instance);
+    INesPPUThread* thread = new INesPPUThread();
+    thread->shadow = INesPPUThreadCreateShadow(instance);
+    for (int i = 0; i < 2; ++i) {
+        INesPPUThreadJob* job = &thread->jobs[i];
+        memset(job, 0, sizeof(INesPPUThreadJob));
+        job->mapperData = instance->mapper->dataSize ? (uint8_t*)malloc(instance->mapper->dataSize) : NULL;
+    }
+    thread->recording = &thread->jobs[0];
+    thread->submitted = NULL;
+    thread->running = true;
+    thread->worker = std::thread(INesPPUThreadMain, thread);
+    instance->renderThread = thread;
+    return true;
+#else
+    (void)instance;
+    return false;
+#endif
+}
+
+void INesPPUThreadStop(INesInstance* instance) {
+#if NES_PPU_THREAD
+    INesPPUThread* thread = instance->renderThread;
+    if (!thread) {
+        return;
+    }
+    INesPPUThreadWait(instance);
+    {
+        std::lock_guard<std::mutex> lock(thread->mutex);
+        thread->running = false;
+    }
+    thread->cond.notify_all();
+    thread->worker.join();
+    instance->renderThread = NULL;
+    // 这一帧已经按跳过渲染开始，从下一行起恢复渲染
+    instance->ppu->skipFrame = instance->renderSkip;
+
+    INesPPUThreadDestroyShadow(thread->shadow);
+    for (int i = 0; i < 2; ++i) {
+        free(thread->jobs[i].mapperData);
+        free(thread->jobs[i].entries);
+    }
+    delete thread;
+#else
+    (void)instance;
+#endif
+}
+
+void INesPPUThreadBeginFrame(INesInstance* instance) {
+#if NES_PPU_THREAD
+    INesPPUThread* thread = instance->renderThread;
+    if (!thread) {
+        return;
+    }
+    INesPPUSync(instance);
+    INesPPUThreadJob* job = thread->recording;
+    INesPPUThreadCopyPPU(&job->ppu, instance->ppu);
+    if (instance->mapper->dataSize) {
+        memcpy(job->mapperData, instance->mapper->data, instance->mapper->dataSize);
+    }
+    job->mirror = instance->mirror;
+    job->startTick = instance->ppu->tick;
+    job->count = 0;
+#else
+    (void)instance;
+#endif
+}
+
+void INesPPUThreadEndFrame(INesInstance* instance) {
+#if NES_PPU_THREAD
+    INesPPUThread* thread = instance->renderThread;
+    if (!thread) {
+        return;
+    }
+    INesPPUThreadJob* job = thread->recording;
+    job->endDot = (uint32_t)(instance->ppu->tick - job->startTick);
+    job->renderSkip = instance->renderSkip;
+    INesPPUFramebuffer* framebuffer = instance->framebuffer;
+    job->pixels = framebuffer ? framebuffer->pixels : NULL;
+    job->pitch = framebuffer ? framebuffer->pitch : 0;
+    job->format = framebuffer ? framebuffer->format : INesPPUPixelFormatARGB8888;
+
+    INesPPUThreadWait(instance);
+    {
+        std::lock_guard<std::mutex> lock(thread->mutex);
+        thread->submitted = job;
+    }
+    thread->cond.notify_all();
+    thread->recording = (job == &thread->jobs[0]) ? &thread->jobs[1] : &thread->jobs[0];
+#else
+    (void)instance;
+#endif
+}
@@ -0,0 +1,155 @@
+#ifndef iNesPPUThread_hpp
+#define iNesPPUThread_hpp
+
+#include "iNesInstance.hpp"
+#include "iNesPPU.hpp"
+#include "iNesPPUFramebuffer.hpp"
+
+#include <stdio.h>
+#include <stdint.h>
+
+// 后台线程渲染。定义为 0 时 INesPPUThreadStart 总是返回 false，记录写入的函数是空函数
+#ifndef NES_PPU_THREAD
+#define NES_PPU_THREAD 1
+#endif
+
+#if NES_PPU_THREAD
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+enum INesPPUThreadEntryType {
+    INesPPUThreadEntryWrite = 0,        // 写入 $2000-$2007，OAM DMA 按 256 次 $2004 写入记录
+    INesPPUThreadEntryRead = 1,         // 读取 $2002、$2007，会改变 w、v 和读取缓冲
+    INesPPUThreadEntryMapperWrite = 2   // 写入 mapper 寄存器，不包括 $6000-$7FFF 的 PRG RAM
+};
+
+// 一次 CPU 对 PPU 可见状态的访问，dot 为相对这一帧开始的 PPU 时钟数
+struct INesPPUThreadEntry {
+    uint32_t dot;
+    uint16_t addr;
+    uint8_t type;
+    uint8_t data;
+};
+
+// CPU 线程执行一帧时记录的内容：开始时的快照和这一帧中的访问
+struct INesPPUThreadJob {
+    INesPPU ppu;                // 不包括 output
+    uint8_t* mapperData;
+    enum INesInstanceMirror mirror;
+    long long startTick;
+    uint32_t endDot;
+    bool renderSkip;
+    void* pixels;               // 提交时的输出帧，为 NULL 时不输出
+    size_t pitch;
+    enum INesPPUPixelFormat format;
+    INesPPUThreadEntry* entries;
+    size_t count;
+    size_t capacity;
+};
+
+#if NES_PPU_THREAD
+// CPU 线程执行第 N + 1 帧时，后台线程在影子实例上重放第 N 帧：从快照开始逐点执行 PPU，
+// 在记录的时钟处重新执行同样的访问，所以渲染结果与在 CPU 线程中渲染相同。
+// CPU 线程中的 PPU 按跳过渲染执行，sprite 0 hit、精灵溢出和 IRQ 仍然同步计算。
+struct INesPPUThread {
+    INesInstance* shadow;
+    INesPPUThreadJob jobs[2];
+    INesPPUThreadJob* recording;        // CPU 线程正在记录的帧
+    INesPPUThreadJob* submitted;        // 后台线程正在渲染的帧，为 NULL 时空闲
+    bool running;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::thread worker;
+};
+#else
+struct INesPPUThread;
+#endif
+
+/*
+ * 函数: INesPPUThreadStart
+ * ------------------------
+ * 创建影子实例并启动后台渲染线程，从下一帧开始由后台线程渲染。
+ * 开启后 INesInstanceFrame 返回时 ppu->output 和输出帧是上一帧的结果，比 CPU 晚一帧。
+ * 每一帧按结束时设置的输出帧写入，后台线程写入时调用方不能读取同一块 pixels，需要每帧交替设置两块。
+ *
+ * 参数 1 instance: Nes 实例
+ *
+ * 返回: 是否已经开启，没有编译 NES_PPU_THREAD 时返回 false
+ */
+bool INesPPUThreadStart(INesInstance* instance);
+
+/*
+ * 函数: INesPPUThreadStop
+ * -----------------------
+ * 等待后台线程渲染完已经提交的帧，取回结果后停止线程，之后恢复在 CPU 线程中渲染。
+ *
+ * 参数 1 instance: Nes 实例
+ *
+ * 返回: 空
+ */
+void INesPPUThreadStop(INesInstance* instance);
+
+/*
+ * 函数: INesPPUThreadBeginFrame
+ * -----------------------------
+ * 在 INesInstanceFrame 开始时调用，记录 PPU、mapper 的快照。
+ *
+ * 参数 1 instance: Nes 实例
+ *
+ * 返回: 空
+ */
+void INesPPUThreadBeginFrame(INesInstance* instance);
+
+/*
+ * 函数: INesPPUThreadEndFrame
+ * ---------------------------
+ * 在 INesInstanceFrame 结束时调用，等待后台线程渲染完上一帧并取回 output，再提交这一帧。
+ *
+ * 参数 1 instance: Nes 实例
+ *
+ * 返回: 空
+ */
+void INesPPUThreadEndFrame(INesInstance* instance);
+
+// 记录已满时容量扩大一倍，供 INesPPUThreadRecord 调用
+void INesPPUThreadGrow(INesPPUThreadJob* job);
+
+/*
+ * 函数: INesPPUThreadRecord
+ * -------------------------
+ * 记录一次会影响渲染的访问，没有开启后台渲染时不做任何事。
+ * 调用时 PPU 已经执行到当前的点，即 pendingDots 为 0 。
+ *
+ * 参数 1 instance: Nes 实例
+ * 参数 2 type: 访问类型
+ * 参数 3 addr: CPU 地址
+ * 参数 4 data: 写入的数据，读取时忽略
+ *
+ * 返回: 空
+ */
+static inline void INesPPUThreadRecord(INesInstance* instance, enum INesPPUThreadEntryType type, uint16_t addr, uint8_t data) {
+#if NES_PPU_THREAD
+    INesPPUThread* thread = instance->renderThread;
+    if (!thread) {
+        return;
+    }
+    INesPPUThreadJob* job = thread->recording;
+    if (job->count == job->capacity) {
+        INesPPUThreadGrow(job);
+    }
+    INesPPUThreadEntry* entry = &job->entries[job->count++];
+    entry->dot = (uint32_t)(instance->ppu->tick - job->startTick);
+    entry->addr = addr;
+    entry->type = (uint8_t)type;
+    entry->data = data;
+#else
+    (void)instance;
+    (void)type;
+    (void)addr;
+    (void)data;
+#endif
+}
+
+#endif /* iNesPPUThread_hpp */
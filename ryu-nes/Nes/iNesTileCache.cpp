@@ -0,0 +1,71 @@
+#include "iNesTileCache.hpp"
+#include "iNesMapper.hpp"
+#include <stdlib.h>
+#include <string.h>
+
+void INesTileCacheCreate(INesInstance* instance) {
+    INesTileCache* cache = (INesTileCache*)malloc(sizeof(INesTileCache));
+    memset(cache, 0, sizeof(INesTileCache));
+    cache->tileCount = (uint32_t)((instance->file->CHRRomSize + 0x2000) >> 4);
+    cache->pixels = (INesTileCachePixels*)malloc(sizeof(INesTileCachePixels) * cache->tileCount);
+    cache->valid = (uint8_t*)malloc(cache->tileCount);
+    memset(cache->valid, 0, cache->tileCount);
+    for (int i = 0; i < 8; ++i) {
+        cache->pages[i] = -1;
+    }
+    instance->tileCache = cache;
+}
+
+void INesTileCacheDestroy(INesInstance* instance) {
+    INesTileCache* cache = instance->tileCache;
+    if (!cache) {
+        return;
+    }
+    free(cache->pixels);
+    free(cache->valid);
+    free(cache);
+    instance->tileCache = NULL;
+}
+
+void INesTileCacheUpdatePages(INesInstance* instance) {
+    INesTileCache* cache = instance->tileCache;
+    if (!cache) {
+        return;
+    }
+    for (uint16_t page = 0; page < 8; ++page) {
+        int32_t offset = INesMapperGetCHROffset(instance, page << 10);
+        if (offset < 0 || (uint32_t)offset + 0x400 > cache->tileCount << 4) {
+            offset = -1;
+        }
+        cache->pages[page] = offset;
+    }
+}
+
+void INesTileCacheInvalidate(INesInstance* instance, uint16_t addr) {
+    INesTileCache* cache = instance->tileCache;
+    int32_t page = cache->pages[(addr >> 10) & 7];
+    if (page >= 0) {
+        cache->valid[(uint32_t)(page + (addr & 0x3ff)) >> 4] = 0;
+    }
+    // NROM 等 mapper 无论是否映射 CHR RAM 都会写入 ppu->mem，对应的 tile 同样失效
+    cache->valid[(uint32_t)(instance->file->CHRRomSize + (addr & 0x1fff)) >> 4] = 0;
+}
+
+void INesTileCacheDecode(INesInstance* instance, uint32_t tile) {
+    INesTileCache* cache = instance->tileCache;
+    size_t offset = (size_t)tile << 4;
+    const uint8_t* data = offset < instance->file->CHRRomSize
+        ? instance->file->CHRRom + offset
+        : instance->ppu->mem + (offset - instance->file->CHRRomSize);
+    INesTileCachePixels* pixels = &cache->pixels[tile];
+    for (int y = 0; y < 8; ++y) {
+        uint8_t lo = data[y];
+        uint8_t hi = data[y + 8];
+        for (int x = 0; x < 8; ++x) {
+            uint8_t value = ((lo >> (7 - x)) & 1) | (((hi >> (7 - x)) & 1) << 1);
+            (*pixels)[0][y][x] = value;
+            (*pixels)[1][y][7 - x] = value;
+        }
+    }
+    cache->valid[tile] = 1;
+}
@@ -0,0 +1,93 @@
+#ifndef iNesTileCache_hpp
+#define iNesTileCache_hpp
+
+#include "iNesInstance.hpp"
+#include "iNesFile.hpp"
+#include "iNesPPU.hpp"
+
+#include <stdio.h>
+#include <stdint.h>
+
+// 每个 tile 的 8 行像素，以及水平翻转后的 8 行，每个像素为 0~3 的图案值
+typedef uint8_t INesTileCachePixels[2][8][8];
+
+// 按 CHR 偏移缓存解码后的 tile。CHR 偏移由 INesMapperGetCHROffset 得到：
+// [0, CHRRomSize) 为 CHR ROM，之后的 0x2000 字节为 ppu->mem 中的 CHR RAM。
+// 切换 bank 只改变 pages，写入 CHR 时使对应的 tile 失效，下次读取时重新解码。
+struct INesTileCache {
+    INesTileCachePixels* pixels;
+    uint8_t* valid;
+    uint32_t tileCount;
+    int32_t pages[8];           // PPU $0000-$1FFF 每 1KB 对应的 CHR 偏移，-1 表示不能直接映射（如 MMC5），需要逐字节读取
+};
+
+/*
+ * 函数: INesTileCacheCreate
+ * -------------------------
+ * 按 CHR ROM 的大小创建 tile 缓存，需要在 INesMapperInit 之前调用。
+ *
+ * 参数 1 instance: Nes 实例
+ *
+ * 返回: 空
+ */
+void INesTileCacheCreate(INesInstance* instance);
+
+/*
+ * 函数: INesTileCacheDestroy
+ * --------------------------
+ * 参数 1 instance: Nes 实例
+ *
+ * 返回: 空
+ */
+void INesTileCacheDestroy(INesInstance* instance);
+
+/*
+ * 函数: INesTileCacheUpdatePages
+ * ------------------------------
+ * 按 mapper 当前的 bank 映射更新 pages，在 INesMapperUpdatePages 中调用。
+ *
+ * 参数 1 instance: Nes 实例
+ *
+ * 返回: 空
+ */
+void INesTileCacheUpdatePages(INesInstance* instance);
+
+/*
+ * 函数: INesTileCacheInvalidate
+ * -----------------------------
+ * CPU 通过 PPUDATA 写入 $0000-$1FFF 之后调用，使被写入的 tile 失效。
+ *
+ * 参数 1 instance: Nes 实例
+ * 参数 2 addr: 写入的 PPU 地址
+ *
+ * 返回: 空
+ */
+void INesTileCacheInvalidate(INesInstance* instance, uint16_t addr);
+
+void INesTileCacheDecode(INesInstance* instance, uint32_t tile);
+
+/*
+ * 函数: INesTileCacheGetRow
+ * -------------------------
+ * 取得图案表中一行 8 个像素的图案值。
+ *
+ * 参数 1 instance: Nes 实例
+ * 参数 2 addr: 图案表中这一行低位平面的地址，即 tile 地址加上行号
+ * 参数 3 flip: 为 true 时返回水平翻转后的像素
+ *
+ * 返回: 8 个像素，所在页不能直接映射时返回 NULL
+ */
+static inline const uint8_t* INesTileCacheGetRow(INesInstance* instance, uint16_t addr, bool flip) {
+    INesTileCache* cache = instance->tileCache;
+    int32_t page = cache->pages[(addr >> 10) & 7];
+    if (page < 0) {
+        return NULL;
+    }
+    uint32_t tile = (uint32_t)(page + (addr & 0x3ff)) >> 4;
+    if (!cache->valid[tile]) {
+        INesTileCacheDecode(instance, tile);
+    }
+    return cache->pixels[tile][flip ? 1 : 0][addr & 7];
+}
+
+#endif /* iNesTileCache_hpp */
@@ -0,0 +1,283 @@
+// nes-aot：从 reset/NMI/IRQ 向量出发遍历 ROM 中可以到达的代码，把其中只访问内部 RAM 的指令段
+// 生成为 C++ 函数，输出的 .cpp 加入工程后，INesInstanceCPUModeJIT 模式下直接执行这些预编译的代码。
+//
+// 用法：nes-aot <rom.nes> <output.cpp>
+//
+// 遍历使用上电时的 PRG bank 映射，之后才映射进来的 bank 中的代码仍然由 JIT 或解释器执行。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "iNesInstance.hpp"
+#include "NesCPUHandlers.hpp"
+#include "NesCPUJit.hpp"
+#include "NesCPUAOT.hpp"
+
+#define AOT_FLAG_INSTRUCTION    (1)     // 指令的起始位置
+#define AOT_FLAG_HEAD           (2)     // 执行可能从这里开始（跳转目标或不能整段执行的指令之后）
+
+static const char* g_handlerNames[0x100] = { 0 };
+
+struct AOTContext {
+    INesInstance* instance;
+    const CPUInstruction* book;
+    size_t PRGRomSize;
+    uint8_t* flags;                     // 每个窗口中每个 PRG ROM 字节的标记
+    ADDR* pending;
+    size_t pendingCount;
+    size_t pendingCapacity;
+};
+
+static uint8_t* AOTFlag(AOTContext* context, int32_t key) {
+    size_t window = (size_t)key >> CPU_BLOCK_KEY_WINDOW_SHIFT;
+    size_t offset = (size_t)key & ((1 << CPU_BLOCK_KEY_WINDOW_SHIFT) - 1);
+    return &context->flags[window * context->PRGRomSize + offset];
+}
+
+// 只遍历映射到 PRG ROM 的代码，返回 -1 表示不处理
+static int32_t AOTKey(AOTContext* context, ADDR pc) {
+    if (pc < 0x8000) {
+        return -1;
+    }
+    int32_t key = CpuCodeKey(context->instance->cpu, context->instance, pc);
+    if (key < 0 || (key & CPU_BLOCK_KEY_RAM)) {
+        return -1;
+    }
+    return key;
+}
+
+static void AOTMarkHead(AOTContext* context, ADDR pc) {
+    int32_t key = AOTKey(context, pc);
+    if (key < 0) {
+        return;
+    }
+    *AOTFlag(context, key) |= AOT_FLAG_HEAD;
+    if (context->pendingCount == context->pendingCapacity) {
+        context->pendingCapacity = context->pendingCapacity ? context->pendingCapacity * 2 : 256;
+        context->pending = (ADDR*)realloc(context->pending, context->pendingCapacity * sizeof(ADDR));
+    }
+    context->pending[context->pendingCount++] = pc;
+}
+
+static ADDR AOTReadWord(AOTContext* context, ADDR addr) {
+    return (ADDR)INesInstanceRead(context->instance, addr) | ((ADDR)INesInstanceRead(context->instance, addr + 1) << 8);
+}
+
+// 顺序遍历直到无条件跳转、返回或已经遍历过的位置
+static void AOTWalk(AOTContext* context, ADDR pc) {
+    while (true) {
+        int32_t key = AOTKey(context, pc);
+        if (key < 0 || (*AOTFlag(context, key) & AOT_FLAG_INSTRUCTION)) {
+            return;
+        }
+        uint8_t opcode = INesInstanceRead(context->instance, pc);
+        const CPUInstruction* info = context->book + opcode;
+        if (info->size == 0) {
+            return;
+        }
+        *AOTFlag(context, key) |= AOT_FLAG_INSTRUCTION;
+
+        uint16_t operand = 0;
+        if (info->size > 1) {
+            operand = INesInstanceRead(context->instance, pc + 1);
+        }
+        if (info->size > 2) {
+            operand |= (uint16_t)INesInstanceRead(context->instance, pc + 2) << 8;
+        }
+        ADDR next = pc + info->size;
+        switch (opcode) {
+            case CORE_CODE_BCC:
+            case CORE_CODE_BCS:
+            case CORE_CODE_BEQ:
+            case CORE_CODE_BMI:
+            case CORE_CODE_BNE:
+            case CORE_CODE_BPL:
+            case CORE_CODE_BVC:
+            case CORE_CODE_BVS:
+                AOTMarkHead(context, next + (int8_t)operand);
+                break;
+            case CORE_CODE_JSR:
+                AOTMarkHead(context, operand);
+                break;
+            case CORE_CODE_JMP_ABSOLUTE:
+                // 不会执行到下一条指令，只沿跳转目标继续
+                AOTMarkHead(context, operand);
+                return;
+            case CORE_CODE_JMP_INDIRECT:
+            case CORE_CODE_RTS:
+            case CORE_CODE_RTI:
+            case CORE_CODE_BRK:
+                return;
+            default:
+                break;
+        }
+        if (!CpuJitIsPure(opcode, operand)) {
+            // 解释器执行完这条指令后从下一条开始查找
+            AOTMarkHead(context, next);
+        }
+        pc = next;
+    }
+}
+
+static uint8_t AOTReadRom(AOTContext* context, size_t offset) {
+    return offset < context->PRGRomSize ? context->instance->file->PRGRom[offset] : 0;
+}
+
+// 从 key 开始连续的 CpuJitIsPure 指令组成一段代码，返回指令条数
+static uint8_t AOTDecodeBlock(AOTContext* context, int32_t key, CPUDecodedInstruction* instructions, uint8_t* cycles) {
+    size_t window = (size_t)key >> CPU_BLOCK_KEY_WINDOW_SHIFT;
+    size_t offset = (size_t)key & ((1 << CPU_BLOCK_KEY_WINDOW_SHIFT) - 1);
+    size_t limit = (offset & ~(size_t)0x1fff) + 0x2000;
+    ADDR pc = (ADDR)(0x8000 + (window << 13) + (offset & 0x1fff));
+    uint8_t count = 0;
+    while (count < CPU_JIT_MAX_INSTRUCTIONS) {
+        uint8_t opcode = AOTReadRom(context, offset);
+        const CPUInstruction* info = context->book + opcode;
+        if (info->size == 0 || offset + info->size > limit) {
+            break;
+        }
+        uint16_t operand = 0;
+        if (info->size > 1) {
+            operand = AOTReadRom(context, offset + 1);
+        }
+        if (info->size > 2) {
+            operand |= (uint16_t)AOTReadRom(context, offset + 2) << 8;
+        }
+        if (!CpuJitIsPure(opcode, operand)) {
+            break;
+        }
+        instructions[count].pc = pc;
+        instructions[count].opcode = opcode;
+        instructions[count].operand = operand;
+        cycles[count] = info->cycle;
+        ++count;
+        pc += info->size;
+        offset += info->size;
+    }
+    return count;
+}
+
+static bool AOTGenerate(AOTContext* context, const char* romPath, FILE* out) {
+    fprintf(out, "// 由 nes-aot 根据 %s 生成，请勿手动修改\n\n", romPath);
+    fprintf(out, "#include \"NesCPUHandlers.hpp\"\n#include \"NesCPUAOT.hpp\"\n\n");
+
+    size_t total = context->PRGRomSize * 4;
+    int32_t* keys = (int32_t*)malloc(sizeof(int32_t) * total);
+    size_t keyCount = 0;
+    CPUDecodedInstruction instructions[CPU_JIT_MAX_INSTRUCTIONS];
+    uint8_t cycles[CPU_JIT_MAX_INSTRUCTIONS];
+    for (size_t i = 0; i < total; ++i) {
+        if ((context->flags[i] & (AOT_FLAG_INSTRUCTION | AOT_FLAG_HEAD)) != (AOT_FLAG_INSTRUCTION | AOT_FLAG_HEAD)) {
+            continue;
+        }
+        int32_t key = (int32_t)(((i / context->PRGRomSize) << CPU_BLOCK_KEY_WINDOW_SHIFT) | (i % context->PRGRomSize));
+        uint8_t count = AOTDecodeBlock(context, key, instructions, cycles);
+        if (count == CPU_JIT_MAX_INSTRUCTIONS) {
+            // 整段执行后从下一条指令开始查找
+            const CPUDecodedInstruction* last = &instructions[count - 1];
+            size_t next = i + (last->pc - instructions[0].pc) + context->book[last->opcode].size;
+            if (next < total && next / context->PRGRomSize == i / context->PRGRomSize) {
+                context->flags[next] |= AOT_FLAG_INSTRUCTION | AOT_FLAG_HEAD;
+            }
+        }
+        if (count < 2) {
+            continue;
+        }
+
+        // 与 CpuJitCode 相同：先消耗 extraCycle，时钟不超过 budget 时执行下一条指令。这些指令没有额外时钟
+        fprintf(out, "// $%04X\n", instructions[0].pc);
+        fprintf(out, "static uint32_t CpuAOTBlock_%07x(CPU2A03* cpu, INesInstance* instance, uint32_t budget) {\n", key);
+        fprintf(out, "    uint32_t cycles = (uint32_t)cpu->extraCycle;\n");
+        fprintf(out, "    if (cycles >= budget) {\n        return 0;\n    }\n");
+        fprintf(out, "    cpu->extraCycle = 0;\n");
+        for (uint8_t j = 0; j < count; ++j) {
+            if (j > 0) {
+                fprintf(out, "    if (cycles >= budget) {\n        return cycles;\n    }\n");
+            }
+            fprintf(out, "    %s(cpu, instance, 0x%04x, 0x%04x); // %s\n", g_handlerNames[instructions[j].opcode],
+                    instructions[j].pc, instructions[j].operand, context->book[instructions[j].opcode].name);
+            fprintf(out, "    cycles += %d;\n", cycles[j]);
+        }
+        fprintf(out, "    return cycles;\n}\n\n");
+        keys[keyCount++] = key;
+    }
+
+    fprintf(out, "static const CPUJitBlock g_blocks[] = {\n");
+    for (size_t i = 0; i < keyCount; ++i) {
+        uint8_t count = AOTDecodeBlock(context, keys[i], instructions, cycles);
+        fprintf(out, "    { 0x%07x, 0, true, %d, CpuAOTBlock_%07x },\n", keys[i], count, keys[i]);
+    }
+    fprintf(out, "};\n\n");
+
+    const INesFile* file = context->instance->file;
+    fprintf(out, "static const CPUAOTProgram g_program = { 0x%08x, %zu, g_blocks, %zu };\n",
+            CpuAOTHashPRGRom(file->PRGRom, file->PRGRomSize), file->PRGRomSize, keyCount);
+    fprintf(out, "static const bool g_registered = CpuAOTRegister(&g_program);\n");
+    free(keys);
+
+    printf("%zu blocks\n", keyCount);
+    return keyCount > 0;
+}
+
+int main(int argc, const char* argv[]) {
+    if (argc < 3) {
+        printf("usage: %s <rom.nes> <output.cpp>\n", argv[0]);
+        return 1;
+    }
+
+    FILE* fp = fopen(argv[1], "rb");
+    if (!fp) {
+        printf("can not open %s\n", argv[1]);
+        return 1;
+    }
+    fseek(fp, 0, SEEK_END);
+    size_t size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    uint8_t* data = (uint8_t*)malloc(size);
+    size_t readSize = fread(data, 1, size, fp);
+    fclose(fp);
+    if (readSize != size) {
+        printf("can not read %s\n", argv[1]);
+        free(data);
+        return 1;
+    }
+
+    INesInstance* instance = INesInstanceCreate(data, size);
+    free(data);
+    if (!instance) {
+        printf("invalid rom %s\n", argv[1]);
+        return 1;
+    }
+
+#define NES_AOT_HANDLER_NAME(code, handler) g_handlerNames[code] = #handler;
+    CPU_HANDLER_LIST(NES_AOT_HANDLER_NAME)
+#undef NES_AOT_HANDLER_NAME
+
+    AOTContext context;
+    memset(&context, 0, sizeof(context));
+    context.instance = instance;
+    context.book = GetCPUInstructionBook(NULL);
+    context.PRGRomSize = instance->file->PRGRomSize;
+    context.flags = (uint8_t*)malloc(context.PRGRomSize * 4);
+    memset(context.flags, 0, context.PRGRomSize * 4);
+
+    AOTMarkHead(&context, AOTReadWord(&context, 0xfffa));
+    AOTMarkHead(&context, AOTReadWord(&context, 0xfffc));
+    AOTMarkHead(&context, AOTReadWord(&context, 0xfffe));
+    while (context.pendingCount > 0) {
+        AOTWalk(&context, context.pending[--context.pendingCount]);
+    }
+
+    FILE* out = fopen(argv[2], "w");
+    if (!out) {
+        printf("can not write %s\n", argv[2]);
+        return 1;
+    }
+    bool generated = AOTGenerate(&context, argv[1], out);
+    fclose(out);
+
+    free(context.flags);
+    free(context.pending);
+    INesInstanceDestroy(instance);
+    return generated ? 0 : 1;
+}
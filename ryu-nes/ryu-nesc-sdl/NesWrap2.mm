@@ -1,5 +1,6 @@
 #import "NesWrap2.h"
 #include "iNesInstance.hpp"
+#include "iNesPPUFramebuffer.hpp"
 #include <chrono>
 
 #define WS          (256)
@@ -23,7 +24,8 @@ static INesInstance* g_instance = NULL;
 volatile static double g_sound[16][SAMPLE] = {};
 volatile static uint64_t g_sound_i1 = 0;
 volatile static uint64_t g_sound_i2 = 0;
-volatile static uint8_t g_ppu_output[16][WS*HS] = {};
+// PPU 直接写入的 ARGB8888 帧，模拟线程写 g_ppu_i2 % 4，SDL 线程读取最近完成的一帧
+static uint32_t g_ppu_frames[4][WS*HS] = {};
 volatile static uint64_t g_ppu_i1 = 0;
 volatile static uint64_t g_ppu_i2 = 0;
 volatile static int g_sound_start = 0;
@@ -87,6 +89,7 @@ static void AudioCallBack(void* userData, Uint8* stream, int length) {
         return ;
     }
     g_instance = instance;
+    INesPPUSetFramebuffer(instance, g_ppu_frames[0], WS*sizeof(uint32_t), INesPPUPixelFormatARGB8888);
     
     if (INesFileContainsMemoryChip(instance->file)) {
         NSString* fileDir = [fileString stringByDeletingLastPathComponent];
@@ -140,8 +143,8 @@ static void AudioCallBack(void* userData, Uint8* stream, int length) {
             }
         }
         
-        memcpy((void*)g_ppu_output[g_ppu_i2%16], (void*)g_instance->ppu->output, HS*WS);
         ++g_ppu_i2;
+        INesPPUSetFramebuffer(instance, g_ppu_frames[g_ppu_i2%4], WS*sizeof(uint32_t), INesPPUPixelFormatARGB8888);
         
         int i = 0;
         while (1) {
@@ -209,7 +212,8 @@ static void AudioCallBack(void* userData, Uint8* stream, int length) {
     SDL_Event event = { 0 };
     
     g_renderer = SDL_CreateRenderer(window, 0, SDL_RENDERER_PRESENTVSYNC);
-    g_texture = SDL_CreateTexture(g_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, (int)width, (int)height);
+    // 纹理保持 NES 原始大小，由 SDL_RenderCopy 放大到窗口
+    g_texture = SDL_CreateTexture(g_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, WS, HS);
     SDL_RegisterEvents(1);
     
     int loop = 1;
@@ -291,24 +295,9 @@ static void AudioCallBack(void* userData, Uint8* stream, int length) {
         
         if (g_ppu_i1 < g_ppu_i2) {
             //printf("%d\n", g_ppu_i2 - g_ppu_i1);
-            uint32_t* pixels;
-            int pitch;
             uint64_t i1 = g_ppu_i2 - 1;
-            SDL_LockTexture(g_texture, NULL, (void**)&pixels, &pitch);
-            uint8_t r, g, b;
-            // 在这里将FC模拟器的像素数据拷贝到pixels中
-            for (int y = 0; y < 240; ++y) {
-                for (int x = 0; x < 256; ++x) {
-                    uint8_t pi = g_ppu_output[i1%16][y*256+x];
-                    INesPPUGetColorByPalleteIndex(pi, &r, &g, &b);
-                    uint32_t pixel = (r << 16) | (g << 8) | b;
-                    pixels[y * 2 * 512 + x * 2] = pixel;
-                    pixels[y * 2 * 512 + (x * 2 + 1)] = pixel;
-                    pixels[(y * 2 + 1) * 512 + x * 2] = pixel;
-                    pixels[(y * 2 + 1) * 512 + (x * 2 + 1)] = pixel;
-                }
-            }
-            SDL_UnlockTexture(g_texture);
+            // PPU 已经写好 ARGB8888 像素，直接上传
+            SDL_UpdateTexture(g_texture, NULL, g_ppu_frames[i1%4], WS*sizeof(uint32_t));
             SDL_RenderCopy(g_renderer, g_texture, NULL, NULL);
             SDL_RenderPresent(g_renderer);
             g_ppu_i1 = i1 + 1;